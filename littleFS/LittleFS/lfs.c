@@ -1737,6 +1737,7 @@ static int lfs_dir_compact(lfs_t *lfs,
     // save some state in case block is bad
     bool relocated = false;
     bool tired = lfs_dir_needsrelocation(lfs, dir);
+    LFS_EVENT(lfs, LFS_EVENT_COMPACT);
 
     // increment revision count
     dir->rev += 1;
@@ -1877,6 +1878,7 @@ static int lfs_dir_compact(lfs_t *lfs,
 relocate:
         // commit was corrupted, drop caches and prepare to relocate block
         relocated = true;
+        LFS_EVENT(lfs, LFS_EVENT_RELOCATE);
         lfs_cache_drop(lfs, &lfs->pcache);
         if (!tired) {
             LFS_DEBUG("Bad block at 0x%"PRIx32, dir->pair[1]);
@@ -2776,6 +2778,7 @@ static int lfs_ctz_extend(lfs_t *lfs,
 
 relocate:
         LFS_DEBUG("Bad block at 0x%"PRIx32, nblock);
+        LFS_EVENT(lfs, LFS_EVENT_RELOCATE);
 
         // just clear cache and try a new block
         lfs_cache_drop(lfs, pcache);
@@ -3086,6 +3089,7 @@ static int lfs_file_relocate(lfs_t *lfs, lfs_file_t *file) {
 
 relocate:
         LFS_DEBUG("Bad block at 0x%"PRIx32, nblock);
+        LFS_EVENT(lfs, LFS_EVENT_RELOCATE);
 
         // just clear cache and try a new block
         lfs_cache_drop(lfs, &lfs->pcache);
@@ -3165,6 +3169,7 @@ static int lfs_file_flush(lfs_t *lfs, lfs_file_t *file) {
 
 relocate:
                 LFS_DEBUG("Bad block at 0x%"PRIx32, file->block);
+                LFS_EVENT(lfs, LFS_EVENT_RELOCATE);
                 err = lfs_file_relocate(lfs, file);
                 if (err) {
                     return err;
@@ -3390,6 +3395,7 @@ static lfs_ssize_t lfs_file_flushedwrite(lfs_t *lfs, lfs_file_t *file,
 
             break;
 relocate:
+            LFS_EVENT(lfs, LFS_EVENT_RELOCATE);
             err = lfs_file_relocate(lfs, file);
             if (err) {
                 file->flags |= LFS_F_ERRED;
@@ -4619,6 +4625,36 @@ static int lfs_fs_forceconsistency(lfs_t *lfs) {
 }
 #endif
 
+#ifndef LFS_READONLY
+static int lfs_fs_rawmkconsistent(lfs_t *lfs) {
+    // lfs_fs_forceconsistency does most of the work here
+    int err = lfs_fs_forceconsistency(lfs);
+    if (err) {
+        return err;
+    }
+
+    // do we have any pending gstate?
+    lfs_gstate_t delta = {0};
+    lfs_gstate_xor(&delta, &lfs->gdisk);
+    lfs_gstate_xor(&delta, &lfs->gstate);
+    if (!lfs_gstate_iszero(&delta)) {
+        // lfs_dir_commit will implicitly write out any pending gstate
+        lfs_mdir_t root;
+        err = lfs_dir_fetch(lfs, &root, lfs->root);
+        if (err) {
+            return err;
+        }
+
+        err = lfs_dir_commit(lfs, &root, NULL, 0);
+        if (err) {
+            return err;
+        }
+    }
+
+    return 0;
+}
+#endif
+
 static int lfs_fs_size_count(void *p, lfs_block_t block) {
     (void)block;
     lfs_size_t *size = p;
@@ -5784,6 +5820,22 @@ int lfs_fs_traverse(lfs_t *lfs, int (*cb)(void *, lfs_block_t), void *data) {
     return err;
 }
 
+#ifndef LFS_READONLY
+int lfs_fs_mkconsistent(lfs_t *lfs) {
+    int err = LFS_LOCK(lfs->cfg);
+    if (err) {
+        return err;
+    }
+    LFS_TRACE("lfs_fs_mkconsistent(%p)", (void*)lfs);
+
+    err = lfs_fs_rawmkconsistent(lfs);
+
+    LFS_TRACE("lfs_fs_mkconsistent -> %d", err);
+    LFS_UNLOCK(lfs->cfg);
+    return err;
+}
+#endif
+
 #ifdef LFS_MIGRATE
 int lfs_migrate(lfs_t *lfs, const struct lfs_config *cfg) {
     int err = LFS_LOCK(cfg);
@@ -99,6 +99,22 @@ extern "C"
 #endif
 #endif
 
+// Instrumentation events, e.g. for counting metadata compactions and block
+// relocations. Define LFS_EVENT_HOOK as the name of a function
+// void hook(const struct lfs_config *cfg, int event) to receive them.
+#define LFS_EVENT_COMPACT  0
+#define LFS_EVENT_RELOCATE 1
+
+#ifndef LFS_EVENT
+#ifdef LFS_EVENT_HOOK
+struct lfs_config;
+void LFS_EVENT_HOOK(const struct lfs_config *cfg, int event);
+#define LFS_EVENT(lfs, event) LFS_EVENT_HOOK((lfs)->cfg, event)
+#else
+#define LFS_EVENT(lfs, event)
+#endif
+#endif
+
 
 // Builtin functions, these may be replaced by more efficient
 // toolchain-specific implementations. LFS_NO_INTRINSICS falls back to a more
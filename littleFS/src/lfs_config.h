@@ -20,8 +20,8 @@
 #define LFS_MALLOC(size) k_malloc(size)
 #define LFS_FREE(ptr) k_free(ptr)
 
-// Thread safety - use Zephyr mutexes if needed
-// For now, assume single-threaded access
-#define LFS_THREADSAFE 0
+// Thread safety - LFS_THREADSAFE is defined in CMakeLists.txt (lfs.h tests
+// it with #ifdef, so it must not be defined here as 0). nor_flash.c wires
+// lfs_config.lock/unlock to per-device Zephyr mutexes.
 
 #endif /* LFS_CONFIG_H */
\ No newline at end of file
@@ -11,8 +11,10 @@
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
 #include <zephyr/pm/pm.h>
 #include <zephyr/pm/policy.h>
+#include <zephyr/sys/timeutil.h>
 #include <hal/nrf_gpio.h>
 #include <string.h>
 #include <stdio.h>
@@ -20,7 +22,6 @@
 #include <errno.h>
 #include "nor_flash.h"
 #include "ds3231.h"
-#include <SEGGER_RTT.h>
 
 /* SLEEP_TIME */
 #define SLEEP_TIME_MS 500
@@ -39,19 +40,90 @@ static const struct gpio_dt_spec red_led = GPIO_DT_SPEC_GET(LED1_NODE, gpios);
 #define WAKEUP_PIN          13
 #define WAKEUP_PORT         1
 
+/*
+ * Boot policy - DEBUG with CONFIG_DEBUG or CONFIG_DEBUG_OPTIMIZATIONS (the
+ * debug.conf overlay), FAST otherwise; a BOOT_POLICY compile definition
+ * overrides both
+ * DEBUG: 2 s SWD flashing window, LED blinks and a blocking 1 s P1.13 check
+ *        before anything else (lets a debugger attach even if P1.13 is LOW)
+ * FAST:  straight to init; P1.13 is debounced by a kernel timer while the
+ *        RTC and flash come up, and checked once flash is mounted
+ */
+#define BOOT_POLICY_FAST    0
+#define BOOT_POLICY_DEBUG   1
+
+#ifndef BOOT_POLICY
+#if defined(CONFIG_DEBUG) || defined(CONFIG_DEBUG_OPTIMIZATIONS)
+#define BOOT_POLICY BOOT_POLICY_DEBUG
+#else
+#define BOOT_POLICY BOOT_POLICY_FAST
+#endif
+#endif
+
+/* P1.13 must stay HIGH this long at boot, sampled every step */
+#define WAKE_DEBOUNCE_MS        1000
+#define WAKE_DEBOUNCE_STEP_MS   100
+
 static const struct device *gpio1_dev;
 static struct gpio_callback wakeup_cb_data;
 static volatile bool sleep_requested = false;
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_DBG);
 
-/* Macro to log and flush RTT buffer with direct RTT write */
-#define LOG_INF_FLUSH(fmt, ...) do { \
-    char _log_buf[256]; \
-    snprintf(_log_buf, sizeof(_log_buf), fmt "\r\n", ##__VA_ARGS__); \
-    SEGGER_RTT_WriteString(0, _log_buf); \
-    k_msleep(100); \
-} while(0)
+/* Boot phase timing - each mark records the time since the previous one */
+#define BOOT_PHASES_MAX 8
+
+static struct {
+	const char *name;
+	uint32_t us;
+} boot_phases[BOOT_PHASES_MAX];
+static size_t boot_phase_count;
+static uint32_t boot_phase_start;
+
+static void boot_phase_mark(const char *name)
+{
+	uint32_t now = k_cycle_get_32();
+
+	if (boot_phase_count < BOOT_PHASES_MAX) {
+		boot_phases[boot_phase_count].name = name;
+		boot_phases[boot_phase_count].us = k_cyc_to_us_floor32(now - boot_phase_start);
+		boot_phase_count++;
+	}
+	boot_phase_start = now;
+}
+
+static void boot_phase_report(void)
+{
+	uint32_t total = 0;
+
+	LOG_INF("Boot phases (%s policy):", BOOT_POLICY == BOOT_POLICY_DEBUG ? "debug" : "fast");
+	for (size_t i = 0; i < boot_phase_count; i++) {
+		LOG_INF("  %-10s %7u us", boot_phases[i].name, boot_phases[i].us);
+		total += boot_phases[i].us;
+	}
+	LOG_INF("  %-10s %7u us (+%u ms before main)", "total", total,
+		      (uint32_t)k_uptime_get_32() - total / 1000);
+}
+
+#if BOOT_POLICY == BOOT_POLICY_FAST
+/* P1.13 debounce run from a kernel timer, in parallel with RTC/flash init */
+static K_SEM_DEFINE(wake_debounce_done, 0, 1);
+static volatile bool wake_debounce_low;
+static int wake_debounce_samples;
+
+static void wake_debounce_fn(struct k_timer *timer)
+{
+	if (nrf_gpio_pin_read(NRF_GPIO_PIN_MAP(WAKEUP_PORT, WAKEUP_PIN)) == 0) {
+		wake_debounce_low = true;
+	}
+	if (wake_debounce_low || ++wake_debounce_samples >= WAKE_DEBOUNCE_MS / WAKE_DEBOUNCE_STEP_MS) {
+		k_timer_stop(timer);
+		k_sem_give(&wake_debounce_done);
+	}
+}
+
+static K_TIMER_DEFINE(wake_debounce_timer, wake_debounce_fn, NULL);
+#endif
 
 /* Data structure for setup.bin file */
 typedef struct {
@@ -61,6 +133,51 @@ typedef struct {
     struct tm setDateTime;
 } MyData;
 
+/* Wall clock for recording time indexes: DS3231 time at boot plus uptime */
+static uint32_t rtc_epoch_at_boot;
+
+static uint32_t rtc_now(void)
+{
+	return rtc_epoch_at_boot + (uint32_t)(k_uptime_get() / 1000);
+}
+
+/* Static window for streaming file reads - no heap, any file size */
+static char read_window[128];
+
+/* Expected contents for verify_window_cb() */
+struct verify_ctx {
+	const char *expected;
+	size_t len;
+	size_t seen;
+	bool match;
+};
+
+/* Stream callback: print each window of a text file */
+static int print_window_cb(const void *data, size_t len, uint32_t offset, void *user_data)
+{
+	/* Deferred logging copies %s arguments by strlen, so terminate a copy */
+	char line[sizeof(read_window) + 1];
+
+	len = MIN(len, sizeof(read_window));
+	memcpy(line, data, len);
+	line[len] = '\0';
+	LOG_INF("  [%u] %s", offset, line);
+	return 0;
+}
+
+/* Stream callback: compare each window against the expected buffer */
+static int verify_window_cb(const void *data, size_t len, uint32_t offset, void *user_data)
+{
+	struct verify_ctx *ctx = user_data;
+
+	if (offset + len > ctx->len || memcmp(ctx->expected + offset, data, len) != 0) {
+		ctx->match = false;
+		return 1;
+	}
+	ctx->seen += len;
+	return 0;
+}
+
 /* List of pins to keep configured during init (not set to Hi-Z) */
 /* Format: {port, pin} - P1.14 (MCU_ACTIVE output), P1.13 (WAKEUP input), LEDs */
 static const struct {
@@ -141,14 +258,24 @@ static void disconnect_pins_for_sleep(void)
     }
 }
 
+/* Keep RAM retained in System OFF so the flash allocator snapshot survives */
+static void retain_ram_for_sleep(void)
+{
+#if NOR_FLASH_MOUNT_SNAPSHOT
+    for (size_t i = 0; i < ARRAY_SIZE(NRF_POWER->RAM); i++) {
+        NRF_POWER->RAM[i].POWERSET = 0xFFFF0000;  /* S0..S15 RETENTION */
+    }
+#endif
+}
+
 /* Enter deep sleep with GPIO wake-up on P1.13 rising edge */
 void enter_deep_sleep(void)
 {
-    LOG_INF_FLUSH("Preparing for deep sleep...");
+    LOG_INF("Preparing for deep sleep...");
     
     /* 5 second countdown with alternating red/blue LED blink each second */
     for (int i = 3; i > 0; i--) {
-        LOG_INF_FLUSH("Entering deep sleep in %d...", i);
+        LOG_INF("Entering deep sleep in %d...", i);
         
         /* Alternate between red and blue LED each second */
         if (i % 2 == 1) {
@@ -161,13 +288,21 @@ void enter_deep_sleep(void)
         k_msleep(1000);
     }
     
-    LOG_INF_FLUSH("Disconnecting pins and entering System OFF...");
+    LOG_INF("Disconnecting pins and entering System OFF...");
     
     /* Turn off all LEDs before going to Hi-Z */
     gpio_pin_set_dt(&red_led, 0);
     gpio_pin_set_dt(&blu_led, 0);
     k_msleep(10);  /* Brief delay to ensure LEDs are off */
     
+    /* Write back batched erase counts, then save allocator state so the
+     * next mount skips the lookahead scan */
+    nor_flash_wear_flush(FLASH1);
+    nor_flash_wear_flush(FLASH2);
+    nor_flash_snapshot_save(FLASH1);
+    nor_flash_snapshot_save(FLASH2);
+    retain_ram_for_sleep();
+    
     /* Set MCU_ACTIVE pin low to indicate sleep */
     gpio_pin_set(gpio1_dev, MCU_ACTIVE_PIN, 0);
     
@@ -179,8 +314,8 @@ void enter_deep_sleep(void)
                              NRF_GPIO_PIN_NOPULL,
                              NRF_GPIO_PIN_SENSE_HIGH);
     
-    LOG_INF_FLUSH("System in Deep Sleep");
-    k_msleep(100);  /* Allow log to flush */
+    LOG_INF("System in Deep Sleep");
+    LOG_PANIC();  /* Drain the deferred log buffer before power-down */
     
     /* Enter System OFF mode - lowest power state
      * Only GPIO DETECT or reset can wake from this state
@@ -197,8 +332,8 @@ void enter_deep_sleep(void)
 /* Enter deep sleep immediately (no countdown) - used at startup if P1.13 is LOW */
 static void enter_deep_sleep_immediate(void)
 {
-    LOG_INF_FLUSH("P1.13 is LOW at startup - entering deep sleep immediately");
-    k_msleep(100);  /* Allow log to flush */
+    LOG_INF("P1.13 is LOW at startup - entering deep sleep immediately");
+    LOG_PANIC();  /* Drain the deferred log buffer before power-down */
     
     /* Set MCU_ACTIVE pin (P1.14) low to indicate sleep */
     nrf_gpio_pin_clear(NRF_GPIO_PIN_MAP(MCU_ACTIVE_PORT, MCU_ACTIVE_PIN));
@@ -208,6 +343,9 @@ static void enter_deep_sleep_immediate(void)
                              NRF_GPIO_PIN_NOPULL,
                              NRF_GPIO_PIN_SENSE_HIGH);
     
+    /* Keep the allocator snapshot (this boot's or the previous one's) alive */
+    retain_ram_for_sleep();
+    
     /* Enter System OFF mode */
     NRF_POWER->SYSTEMOFF = 1;
     __DSB();
@@ -231,13 +369,18 @@ int main(void)
 {
 	int ret;
 
+	boot_phase_start = k_cycle_get_32();
+
 	/*========================================================================
 	 * EARLY INITIALIZATION - Before any peripherals
 	 * Set all pins to Hi-Z except P1.13, P1.14, and LEDs
 	 *========================================================================*/
 	
+#if BOOT_POLICY == BOOT_POLICY_DEBUG
 	/* 2 second delay at startup to allow flashing even if P1.13 is LOW */
 	k_msleep(2000);
+	boot_phase_mark("swd-window");
+#endif
 	
 	/* Configure P1.14 as output HIGH (MCU active indicator) using direct nrf_gpio */
 	nrf_gpio_cfg_output(NRF_GPIO_PIN_MAP(MCU_ACTIVE_PORT, MCU_ACTIVE_PIN));
@@ -249,6 +392,11 @@ int main(void)
 	/* Set all other pins to Hi-Z except P1.13, P1.14, and LED pins */
 	disconnect_pins_for_init();
 	
+#if BOOT_POLICY == BOOT_POLICY_FAST
+	/* Debounce P1.13 in the background; the result is checked after mount */
+	k_timer_start(&wake_debounce_timer, K_MSEC(WAKE_DEBOUNCE_STEP_MS), K_MSEC(WAKE_DEBOUNCE_STEP_MS));
+	boot_phase_mark("pins");
+#else
 	/* Quick LED blink to show system is alive (Red then Blue) */
 	/* LEDs are active low on this board, so we use nrf_gpio directly */
 	nrf_gpio_cfg_output(NRF_GPIO_PIN_MAP(1, 4));  /* Red LED P1.04 */
@@ -262,11 +410,11 @@ int main(void)
 	nrf_gpio_pin_set(NRF_GPIO_PIN_MAP(1, 7));     /* Blue OFF */
 	
 	/* Check if P1.13 is HIGH - if LOW, go to deep sleep immediately */
-	LOG_INF_FLUSH("Checking P1.13 wake signal...");
+	LOG_INF("Checking P1.13 wake signal...");
 	
 	/* Wait 1 second and verify P1.13 stays HIGH */
-	for (int i = 0; i < 10; i++) {
-		k_msleep(100);
+	for (int i = 0; i < WAKE_DEBOUNCE_MS / WAKE_DEBOUNCE_STEP_MS; i++) {
+		k_msleep(WAKE_DEBOUNCE_STEP_MS);
 		if (nrf_gpio_pin_read(NRF_GPIO_PIN_MAP(WAKEUP_PORT, WAKEUP_PIN)) == 0) {
 			/* P1.13 is LOW - external MCU wants us to sleep */
 			enter_deep_sleep_immediate();
@@ -274,7 +422,9 @@ int main(void)
 		}
 	}
 	
-	LOG_INF_FLUSH("P1.13 is HIGH - continuing startup");
+	LOG_INF("P1.13 is HIGH - continuing startup");
+	boot_phase_mark("wake-check");
+#endif
 
 	/*========================================================================
 	 * NORMAL INITIALIZATION
@@ -332,6 +482,7 @@ int main(void)
 	gpio_init_callback(&wakeup_cb_data, wakeup_pin_callback, BIT(WAKEUP_PIN));
 	gpio_add_callback(gpio1_dev, &wakeup_cb_data);
 
+#if BOOT_POLICY == BOOT_POLICY_DEBUG
 	/* Blink LEDs to show system is starting */
 	gpio_pin_set_dt(&red_led, 1);
 	k_msleep(200);
@@ -339,10 +490,12 @@ int main(void)
 	gpio_pin_set_dt(&blu_led, 1);
 	k_msleep(200);
 	gpio_pin_set_dt(&blu_led, 0);
+#endif
+	boot_phase_mark("gpio");
 
 	// ******************** DS3231 RTC Initialization **************
 
-	LOG_INF_FLUSH("Initializing DS3231 RTC...");
+	LOG_INF("Initializing DS3231 RTC...");
 
 	struct ds3231_dev *rtc = ds3231_init("I2C_0");
 	if (!rtc) {
@@ -363,79 +516,95 @@ int main(void)
 		if (ret < 0) {
 			LOG_ERR("Failed to set DS3231 time: %d", ret);
 		} else {
-			LOG_INF_FLUSH("DS3231 time set to 2026-01-22 10:00:00 AM");
+			LOG_INF("DS3231 time set to 2026-01-22 10:00:00 AM");
+		}
+
+		/* Read once here; the write path must not wait on I2C */
+		struct tm boot_time;
+		if (ds3231_get_datetime(rtc, &boot_time) == 0) {
+			rtc_epoch_at_boot = (uint32_t)timeutil_timegm64(&boot_time) - (uint32_t)(k_uptime_get() / 1000);
+			nor_flash_set_time_source(rtc_now);
 		}
 	}
+	boot_phase_mark("rtc");
 
 	// ******************** Little FS test **************
 
 	char write_data[] = "Hello, Dual NOR Flash with LittleFS!";
 
-	LOG_INF_FLUSH("Starting Dual NOR Flash Demo");
+	LOG_INF("Starting Dual NOR Flash Demo");
+
+	// Mount LittleFS on both devices; nothing is written until the start stage
+	nor_flash_system_mount();
+	boot_phase_mark("flash");
+
+#if BOOT_POLICY == BOOT_POLICY_FAST
+	/* Mounting wrote nothing and repair/pre-erase have not started yet -
+	 * go back to sleep if P1.13 dropped */
+	k_sem_take(&wake_debounce_done, K_FOREVER);
+	if (wake_debounce_low) {
+		nor_flash_snapshot_save(FLASH1);
+		nor_flash_snapshot_save(FLASH2);
+		enter_deep_sleep_immediate();
+		/* Never returns */
+	}
+	boot_phase_mark("wake-check");
+#endif
 
-	// Initialize the full system with LittleFS
-	ret = nor_flash_system_init();
+	// Repair and start background work; a device that failed stays
+	// unusable (-ENODEV) and the other one carries on
+	ret = nor_flash_system_start();
 	if (ret != 0) {
-		LOG_ERR("System initialization failed");
-		return ret;
+		LOG_ERR("System initialization incomplete (FLASH1 %d, FLASH2 %d)",
+			nor_flash_init_status(FLASH1), nor_flash_init_status(FLASH2));
 	}
+	boot_phase_mark("repair");
 
-	// Read test file from FLASH1 - get file size first
+	// Read test file from FLASH1 - streamed through the static window
 	int file_size = nor_flash_get_file_size(FLASH1, "max_test.txt");
 	if (file_size > 0) {
-		/* Allocate buffer based on file size (+1 for null terminator) */
-		char *read_buffer = k_malloc(file_size + 1);
-		if (read_buffer != NULL) {
-			memset(read_buffer, 0, file_size + 1);
-			ret = nor_flash_read_file(FLASH1, "max_test.txt", read_buffer, file_size);
-			if (ret >= 0) {
-				read_buffer[ret] = '\0';  /* Ensure null termination */
-				LOG_INF_FLUSH("Read max_test.txt (%d bytes): %s", ret, read_buffer);
-			} else {
-				LOG_ERR("Read max_test.txt failed: %d", ret);
-			}
-			k_free(read_buffer);
-		} else {
-			LOG_ERR("Failed to allocate %d bytes for max_test.txt", file_size + 1);
+		LOG_INF("Read max_test.txt (%d bytes):", file_size);
+		ret = nor_flash_read_stream(FLASH1, "max_test.txt", read_window, sizeof(read_window),
+					    print_window_cb, NULL);
+		if (ret < 0) {
+			LOG_ERR("Read max_test.txt failed: %d", ret);
 		}
 	} else if (file_size == 0) {
-		LOG_INF_FLUSH("max_test.txt is empty");
+		LOG_INF("max_test.txt is empty");
 	} else {
-		LOG_INF_FLUSH("max_test.txt not found or error: %d", file_size);
+		LOG_INF("max_test.txt not found or error: %d", file_size);
 	}
 
 	// Write nrf_test file to FLASH1 (SPIFX - 16MB)
 	ret = nor_flash_write_file(FLASH1, "nrf_test.txt", write_data, strlen(write_data));
 	if (ret != 0) {
-		LOG_ERR("Write nrf_test.txt failed");
-		return ret;
+		LOG_ERR("Write nrf_test.txt failed: %d", ret);
 	}
 
-	// Read test file from FLASH1 - dynamic buffer
-	file_size = nor_flash_get_file_size(FLASH1, "nrf_test.txt");
-	if (file_size > 0) {
-		char *read_buffer = k_malloc(file_size + 1);
-		if (read_buffer != NULL) {
-			memset(read_buffer, 0, file_size + 1);
-			ret = nor_flash_read_file(FLASH1, "nrf_test.txt", read_buffer, file_size);
-			if (ret >= 0) {
-				read_buffer[ret] = '\0';
-				LOG_INF_FLUSH("Read nrf_test.txt: %s", read_buffer);
-
-				// Verify data
-				if (strcmp(write_data, read_buffer) == 0) {
-					LOG_INF_FLUSH("Data verification successful!");
-				} else {
-					LOG_ERR("Data verification failed!");
-				}
-			}
-			k_free(read_buffer);
+	// Read test file back from FLASH1 and verify it window by window
+	struct verify_ctx verify = {
+		.expected = write_data,
+		.len = strlen(write_data),
+		.match = true,
+	};
+	ret = nor_flash_read_stream(FLASH1, "nrf_test.txt", read_window, sizeof(read_window),
+				    verify_window_cb, &verify);
+	if (ret < 0) {
+		LOG_ERR("Read nrf_test.txt failed: %d", ret);
+	} else {
+		LOG_INF("Read nrf_test.txt: %u bytes", (unsigned int)verify.seen);
+
+		// Verify data
+		if (verify.match && verify.seen == verify.len) {
+			LOG_INF("Data verification successful!");
+		} else {
+			LOG_ERR("Data verification failed!");
 		}
 	}
 
 	// ******************** Setup.bin struct test **************
 
-	LOG_INF_FLUSH("Reading max_test_data.bin file from FLASH2 (QSPI - 64MB)...");
+	LOG_INF("Reading max_test_data.bin file from FLASH2 (QSPI - 64MB)...");
 
 	MyData readData;
 	static char dateTimeStr[128];
@@ -444,7 +613,7 @@ int main(void)
 	ret = nor_flash_read_struct(FLASH2, "max_test_data.bin", &readData, sizeof(MyData));
 
 	if (ret == -ENOENT) {
-		LOG_INF_FLUSH("max_test_data.bin file does not exist");
+		LOG_INF("max_test_data.bin file does not exist");
 	} else if (ret < 0) {
 		LOG_ERR("Failed to read max_test_data.bin file: error %d", ret);
 	} else {
@@ -456,15 +625,14 @@ int main(void)
 			 readData.setDateTime.tm_min,
 			 readData.setDateTime.tm_sec);
 
-		LOG_INF_FLUSH("MAX Setup Data Read Successfully:");
-		LOG_INF_FLUSH("  ID: %d", readData.id);
-		LOG_INF_FLUSH("  Name: %s", readData.name);
-		LOG_INF_FLUSH("  Temperature: %.1fC", (double)readData.temperature_c);
-		LOG_INF_FLUSH("  Date/Time: %s", dateTimeStr);
-		k_msleep(50);
+		LOG_INF("MAX Setup Data Read Successfully:");
+		LOG_INF("  ID: %d", readData.id);
+		LOG_INF("  Name: %s", readData.name);
+		LOG_INF("  Temperature: %.1fC", (double)readData.temperature_c);
+		LOG_INF("  Date/Time: %s", dateTimeStr);
 	}
 
-	LOG_INF_FLUSH("Writing nrf_test_data.bin file to FLASH2 (QSPI - 64MB)...");
+	LOG_INF("Writing nrf_test_data.bin file to FLASH2 (QSPI - 64MB)...");
 
 	MyData writeData = {
 		.id = 42,
@@ -478,15 +646,15 @@ int main(void)
 	if (ret != 0) {
 		LOG_ERR("Failed to write nrf_test_data.bin file: error %d", ret);
 	} else {
-		LOG_INF_FLUSH("nrf_test_data.bin file written successfully to FLASH2");
+		LOG_INF("nrf_test_data.bin file written successfully to FLASH2");
 	}
 
-	LOG_INF_FLUSH("Reading nrf_test_data.bin file from FLASH2...");
+	LOG_INF("Reading nrf_test_data.bin file from FLASH2...");
 
 	ret = nor_flash_read_struct(FLASH2, "nrf_test_data.bin", &readData, sizeof(MyData));
 
 	if (ret == -ENOENT) {
-		LOG_INF_FLUSH("nrf_test_data.bin file does not exist");
+		LOG_INF("nrf_test_data.bin file does not exist");
 	} else if (ret < 0) {
 		LOG_ERR("Failed to read nrf_test_data.bin file: error %d", ret);
 	} else {
@@ -498,12 +666,11 @@ int main(void)
 			 readData.setDateTime.tm_min,
 			 readData.setDateTime.tm_sec);
 
-		LOG_INF_FLUSH("NRF Setup Data Read Successfully:");
-		LOG_INF_FLUSH("  ID: %d", readData.id);
-		LOG_INF_FLUSH("  Name: %s", readData.name);
-		LOG_INF_FLUSH("  Temperature: %.1f C", (double)readData.temperature_c);
-		LOG_INF_FLUSH("  Date/Time: %s", dateTimeStr);
-		k_msleep(50);
+		LOG_INF("NRF Setup Data Read Successfully:");
+		LOG_INF("  ID: %d", readData.id);
+		LOG_INF("  Name: %s", readData.name);
+		LOG_INF("  Temperature: %.1f C", (double)readData.temperature_c);
+		LOG_INF("  Date/Time: %s", dateTimeStr);
 	}
 
 	// ******************** End of Little FS test **************
@@ -516,7 +683,7 @@ int main(void)
 		if (ret < 0) {
 			LOG_ERR("Failed to read DS3231 time: %d", ret);
 		} else {
-			LOG_INF_FLUSH("DS3231 Current Time: %04d-%02d-%02d %02d:%02d:%02d",
+			LOG_INF("DS3231 Current Time: %04d-%02d-%02d %02d:%02d:%02d",
 				current_time.tm_year + 1900,
 				current_time.tm_mon + 1,
 				current_time.tm_mday,
@@ -528,15 +695,19 @@ int main(void)
 
 	// ******************** End of DS3231 RTC Read **************
 
-	LOG_INF_FLUSH("All tests completed successfully!");
-	LOG_INF_FLUSH("System running - P1.13 LOW will trigger deep sleep");
-	k_msleep(200);
+	boot_phase_mark("demo");
+	boot_phase_report();
+	nor_flash_dump_stats(FLASH1);
+	nor_flash_dump_stats(FLASH2);
+
+	LOG_INF("All tests completed successfully!");
+	LOG_INF("System running - P1.13 LOW will trigger deep sleep");
 
 	/* Main loop - blink blue LED periodically */
 	while (1) {
 		/* Check if sleep was requested via P1.13 interrupt */
 		if (sleep_requested) {
-			LOG_INF_FLUSH("Sleep signal received (P1.13 went LOW)");
+			LOG_INF("Sleep signal received (P1.13 went LOW)");
 			enter_deep_sleep();
 			/* Never returns */
 		}
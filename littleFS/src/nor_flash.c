@@ -11,6 +11,11 @@
 #include <zephyr/drivers/spi.h>
 #include <zephyr/drivers/flash.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/timeutil.h>
+#include <zephyr/timing/timing.h>
 #include <string.h>
 #include "../LittleFS/lfs.h"
 #include "nor_flash.h"
@@ -23,27 +28,160 @@ LOG_MODULE_REGISTER(nor_flash, LOG_LEVEL_INF);
 
 /* MX25L Commands (for Flash1 SPI) */
 #define CMD_READ_DATA        0x03
+#define CMD_FAST_READ        0x0B
+#define CMD_READ_SFDP        0x5A
 #define CMD_PAGE_PROGRAM     0x02
 #define CMD_SECTOR_ERASE     0x20
+#define CMD_BLOCK_ERASE_32K  0x52
+#define CMD_BLOCK_ERASE_64K  0xD8
+#define CMD_CHIP_ERASE       0x60
 #define CMD_WRITE_ENABLE     0x06
 #define CMD_READ_STATUS      0x05
 #define CMD_JEDEC_ID         0x9F
 #define CMD_RELEASE_PD       0xAB
+#define CMD_READ_SECURITY    0x2B
+#define CMD_SUSPEND          0xB0
+#define CMD_RESUME           0x30
+#define CMD_RESET_ENABLE     0x66
+#define CMD_RESET            0x99
+
+/* MX25L 4-byte address command set (parts above 16MB) */
+#define CMD_READ_DATA_4B     0x13
+#define CMD_FAST_READ_4B     0x0C
+#define CMD_PAGE_PROGRAM_4B  0x12
+#define CMD_SECTOR_ERASE_4B  0x21
+#define CMD_BLOCK_ERASE_32K_4B 0x5C
+#define CMD_BLOCK_ERASE_64K_4B 0xDC
+
+/* Flash1 address width follows the configured chip size */
+#if FLASH1_CHIP_SIZE_BYTES > 16777216UL
+#define FLASH1_ADDR_4B       1
+#else
+#define FLASH1_ADDR_4B       0
+#endif
+
+/* Flash1 read bursts: EasyDMA transfers are limited to 16-bit lengths */
+#ifndef FLASH1_READ_CHUNK_SIZE
+#define FLASH1_READ_CHUNK_SIZE   32768
+#endif
+#define FLASH1_READ_MAX_CHUNKS   8
+
+/* SPI clock limit for Flash1 from devicetree */
+#define FLASH1_SPI_MAX_FREQ  DT_PROP(DT_NODELABEL(mx25l12845g), spi_max_frequency)
+
+/* What the SPIM instance can clock: SPIM3 up to 32MHz, SPIM0-2 up to 8MHz */
+#define FLASH1_SPIM_MAX_FREQ (DT_SAME_NODE(DT_BUS(DT_NODELABEL(mx25l12845g)), DT_NODELABEL(spi3)) ? \
+                              32000000 : 8000000)
+#define FLASH1_BUS_MAX_FREQ  MIN(FLASH1_SPI_MAX_FREQ, FLASH1_SPIM_MAX_FREQ)
+
+/* SFDP header / Basic Flash Parameter Table */
+#define SFDP_SIGNATURE       0x50444653  /* "SFDP" */
+#define SFDP_BFPT_114_READ   BIT(22)
+#define SFDP_BFPT_144_READ   BIT(21)
+
+/* Flash1 read engines */
+struct flash1_read_mode {
+    const char *name;
+    uint8_t opcode;
+    uint8_t opcode_4b;
+    uint8_t dummy_bytes;
+    uint32_t max_freq;
+};
+
+static const struct flash1_read_mode flash1_read_modes[] = {
+    [FLASH1_READ_MODE_NORMAL] = {"READ 0x03", CMD_READ_DATA, CMD_READ_DATA_4B, 0, 50000000},
+    [FLASH1_READ_MODE_FAST]   = {"FAST_READ 0x0B", CMD_FAST_READ, CMD_FAST_READ_4B, 1, 133000000},
+};
+
+/*
+ * Flash1 ready-wait profiles, one per operation type. The status register is
+ * busy-polled for spin_us (sized from the MX25L typical time), then polled with
+ * k_usleep() back-off doubling from backoff_us up to backoff_max_us.
+ * Override any profile from CMakeLists.txt as {spin_us, backoff_us,
+ * backoff_max_us, timeout_ms}.
+ */
+enum flash1_wait_op {
+    FLASH1_WAIT_PROGRAM,     /* tPP typ 0.25ms, max 0.75ms */
+    FLASH1_WAIT_ERASE_4K,    /* tSE typ 30ms, max 400ms */
+    FLASH1_WAIT_ERASE_32K,   /* tBE32K typ 0.18s, max 1s */
+    FLASH1_WAIT_ERASE_64K,   /* tBE typ 0.38s, max 2s */
+    FLASH1_WAIT_ERASE_CHIP,  /* tCE typ 110s (256Mb), max 210s; scales with size */
+};
+
+struct flash1_wait_profile {
+    uint32_t spin_us;
+    uint32_t backoff_us;
+    uint32_t backoff_max_us;
+    uint32_t timeout_ms;
+};
+
+#ifndef FLASH1_WAIT_PROFILE_PROGRAM
+#define FLASH1_WAIT_PROFILE_PROGRAM   {1000, 50, 400, 10}
+#endif
+#ifndef FLASH1_WAIT_PROFILE_ERASE_4K
+#define FLASH1_WAIT_PROFILE_ERASE_4K  {0, 1000, 8000, 1000}
+#endif
+#ifndef FLASH1_WAIT_PROFILE_ERASE_32K
+#define FLASH1_WAIT_PROFILE_ERASE_32K {0, 10000, 40000, 2000}
+#endif
+#ifndef FLASH1_WAIT_PROFILE_ERASE_64K
+#define FLASH1_WAIT_PROFILE_ERASE_64K {0, 20000, 80000, 4000}
+#endif
+#ifndef FLASH1_WAIT_PROFILE_ERASE_CHIP
+#define FLASH1_WAIT_PROFILE_ERASE_CHIP {0, 100000, 1000000, 600000}
+#endif
+
+/* Delay between status reads inside the busy-poll window */
+#define FLASH1_SPIN_POLL_US  10
+
+static const struct flash1_wait_profile flash1_wait_profiles[] = {
+    [FLASH1_WAIT_PROGRAM]  = FLASH1_WAIT_PROFILE_PROGRAM,
+    [FLASH1_WAIT_ERASE_4K] = FLASH1_WAIT_PROFILE_ERASE_4K,
+    [FLASH1_WAIT_ERASE_32K] = FLASH1_WAIT_PROFILE_ERASE_32K,
+    [FLASH1_WAIT_ERASE_64K] = FLASH1_WAIT_PROFILE_ERASE_64K,
+    [FLASH1_WAIT_ERASE_CHIP] = FLASH1_WAIT_PROFILE_ERASE_CHIP,
+};
 
 /* Status Register Bits */
 #define SR_BUSY              BIT(0)
 #define SR_WEL               BIT(1)
 
+/* Security Register Bits */
+#define SCUR_ESB             BIT(3)  /* Erase suspended */
+
+/*
+ * Erase suspend: a read arriving while a sector/block erase is in progress
+ * suspends the erase (B0h), runs, and the erase is resumed (30h) afterwards.
+ * tESL is the suspend-to-read latency, tERS the minimum resume-to-suspend gap.
+ * Only erases issued outside lfs1_lock can be suspended for LittleFS reads
+ * (pre-erase pool, wear table, nor_flash_erase_range()); an erase LittleFS
+ * issues itself runs under that lock, which its readers need too, so they
+ * wait for it to finish.
+ */
+#ifndef FLASH1_ERASE_SUSPEND
+#define FLASH1_ERASE_SUSPEND 1
+#endif
+#define FLASH1_TESL_US       20
+#define FLASH1_TERS_US       100
+
+/* Software reset recovery, worst case (reset during chip erase) */
+#define FLASH1_TREADY2_MS    100
+
 /* Flash1 Device Structure (SPI) */
 struct flash1_dev {
     const struct device *spi_dev;
     struct spi_config spi_cfg;
-    const struct device *gpio_dev;
-    gpio_pin_t cs_pin;
     bool initialized;
     const char *name;
     uint32_t size_bytes;
     uint32_t jedec_id;
+    const struct flash1_read_mode *read_mode;
+    struct k_mutex lock;     /* Serializes command sequences (WREN/PP/busy) */
+    atomic_t read_pending;   /* Readers waiting for the lock */
+    struct k_sem read_kick;  /* Wakes an erase back-off when a reader arrives */
+    struct k_condvar reads_done;
+    struct k_condvar resumed;
+    bool erase_suspended;
 };
 
 /* Global instances */
@@ -53,20 +191,129 @@ static bool flash2_initialized = false;
 
 /* LittleFS instances */
 static lfs_t lfs1, lfs2;
-static uint8_t lfs1_read_buf[FLASH_PAGE_SIZE], lfs1_prog_buf[FLASH_PAGE_SIZE];
-static uint8_t lfs2_read_buf[FLASH_PAGE_SIZE], lfs2_prog_buf[FLASH_PAGE_SIZE];
-static uint8_t __aligned(4) lfs1_look_buf[256];
-static uint8_t __aligned(4) lfs2_look_buf[256];
+static uint8_t __aligned(4) lfs1_read_buf[FLASH1_LFS_CACHE_SIZE], lfs1_prog_buf[FLASH1_LFS_CACHE_SIZE];
+static uint8_t __aligned(4) lfs2_read_buf[FLASH2_LFS_CACHE_SIZE], lfs2_prog_buf[FLASH2_LFS_CACHE_SIZE];
+static uint8_t __aligned(4) lfs1_look_buf[FLASH1_LFS_LOOKAHEAD_SIZE];
+static uint8_t __aligned(4) lfs2_look_buf[FLASH2_LFS_LOOKAHEAD_SIZE];
+static bool lfs1_mounted, lfs2_mounted;
+static bool lfs1_readonly, lfs2_readonly;   /* Mounted but repair failed */
+
+/*
+ * Per-device filesystem locks. LittleFS takes them on every API call through
+ * lfs_config.lock/unlock (LFS_THREADSAFE) and holds them for the whole call,
+ * including any erase it issues; they are recursive, so sequences that must
+ * be atomic (format) hold them across several calls. Background erases (the
+ * pre-erase pool, wear table write-back, raw log) only take them briefly or
+ * not at all, so they never stall filesystem calls, and on FLASH1 a
+ * LittleFS read can suspend them. FLASH1 and FLASH2 never share a lock and
+ * run fully in parallel.
+ */
+static K_MUTEX_DEFINE(lfs1_lock);
+static K_MUTEX_DEFINE(lfs2_lock);
+
+/* Open-file handles with their own cache buffer (at least lfs cache_size) */
+#if NOR_FLASH_TIME_INDEX_KB > 0
+#define TIME_INDEX_ATTR      0x74  /* LittleFS custom attribute type ('t') */
+#define TIME_INDEX_SIZE(n)   (offsetof(struct time_index, entry) + (n) * sizeof(struct time_index_entry))
+
+struct time_index_entry {
+    uint32_t time;             /* Seconds since 1970 */
+    uint32_t off;              /* File offset written at that time */
+};
+
+/* Stored as-is in the attribute, trimmed to count entries */
+struct time_index {
+    uint32_t interval;         /* Minimum bytes between entries */
+    uint32_t count;
+    uint32_t end_time;         /* Time and file size at the last sync */
+    uint32_t end_off;
+    struct time_index_entry entry[NOR_FLASH_TIME_INDEX_ENTRIES];
+};
+#endif
+
+struct nor_flash_file {
+    lfs_file_t file;
+    struct lfs_file_config cfg;
+    lfs_t *lfs;
+    flash_device_t device;
+    atomic_t in_use;
+#if NOR_FLASH_TIME_INDEX_KB > 0
+    bool indexing;             /* Writer with a time source */
+    struct lfs_attr index_attr;
+    struct time_index index;
+#endif
+    uint8_t __aligned(4) cache[MAX(FLASH1_LFS_CACHE_SIZE, FLASH2_LFS_CACHE_SIZE)];
+};
+
+static struct nor_flash_file file_pool[NOR_FLASH_MAX_OPEN_FILES];
+
+#if NOR_FLASH_PREERASE_POOL > 0
+/* Blocks known to be erased (bit set after an erase, cleared by any prog) */
+static uint32_t lfs1_erased_map[DIV_ROUND_UP(FLASH1_CHIP_SIZE_BYTES / FLASH_SECTOR_SIZE, 32)];
+static uint32_t lfs2_erased_map[DIV_ROUND_UP(FLASH2_CHIP_SIZE_BYTES / FLASH_SECTOR_SIZE, 32)];
+
+static inline bool erased_map_test(const uint32_t *map, lfs_block_t block)
+{
+    return (map[block / 32] & BIT(block % 32)) != 0;
+}
+
+static inline void erased_map_set(uint32_t *map, lfs_block_t block, bool erased)
+{
+    if (erased) {
+        map[block / 32] |= BIT(block % 32);
+    } else {
+        map[block / 32] &= ~BIT(block % 32);
+    }
+}
+
+/*
+ * Block the pre-erase thread has picked and erases without the fs lock.
+ * block and taken only change under the fs lock; erasing is set while the
+ * erase runs and done is given when it ends.
+ */
+#define PREERASE_NONE  ((lfs_block_t)-1)
+
+struct preerase_claim {
+    lfs_block_t block;       /* PREERASE_NONE if none */
+    bool taken;              /* LittleFS erased or programmed it meanwhile */
+    atomic_t erasing;
+    struct k_sem *done;
+};
+
+static K_SEM_DEFINE(lfs1_preerase_done, 0, 1);
+static K_SEM_DEFINE(lfs2_preerase_done, 0, 1);
+static struct preerase_claim preerase_claim[2] = {
+    [FLASH1] = {.block = PREERASE_NONE, .done = &lfs1_preerase_done},
+    [FLASH2] = {.block = PREERASE_NONE, .done = &lfs2_preerase_done},
+};
+
+/* From lfsN_prog()/lfsN_erase() with the fs lock held: an erase of the
+ * claimed block waits for the pre-erase so the two never interleave */
+static void preerase_claim_check(flash_device_t device, lfs_block_t block, bool erase)
+{
+    struct preerase_claim *c = &preerase_claim[device];
+    
+    if (block != c->block) return;
+    c->taken = true;
+    if (erase && atomic_get(&c->erasing)) {
+        k_sem_take(c->done, K_FOREVER);
+    }
+}
+#endif
 
 /* Forward declarations - Flash1 SPI functions */
 static int flash1_transceive(const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len);
-static int flash1_wait_ready(void);
+static int flash1_wait_ready(enum flash1_wait_op op);
 static int flash1_read_status(uint8_t *status);
 static int flash1_write_enable(void);
 static int flash1_read_id(uint8_t *id);
 static int flash1_read_data(uint32_t addr, void *buf, size_t size);
 static int flash1_prog_data(uint32_t addr, const void *buf, size_t size);
 static int flash1_erase_sector(uint32_t addr);
+static int flash1_erase_range(uint32_t addr, size_t len);
+
+/* Raw erase of either device, for the driver's own regions */
+static int erase_range_counted(flash_device_t device, uint32_t addr, size_t len);
 
 /* LittleFS callbacks */
 static int lfs1_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buf, lfs_size_t size);
@@ -77,69 +324,225 @@ static int lfs2_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t of
 static int lfs2_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buf, lfs_size_t size);
 static int lfs2_erase(const struct lfs_config *c, lfs_block_t block);
 static int lfs2_sync(const struct lfs_config *c);
+static int lfs_lock_cb(const struct lfs_config *c);
+static int lfs_unlock_cb(const struct lfs_config *c);
+
+/*
+ * Device layout in 4KB blocks: LittleFS from block 0 up, the raw region for
+ * async programs, then the two copies of the wear table at the top of the
+ * chip. On FLASH2 the raw log goes below the wear table, 64KB aligned.
+ */
+#define FLASH1_BLOCKS        (FLASH1_CHIP_SIZE_BYTES / FLASH_SECTOR_SIZE)
+#define FLASH2_BLOCKS        (FLASH2_CHIP_SIZE_BYTES / FLASH_SECTOR_SIZE)
+#if NOR_FLASH_WEAR_TRACK
+#define WEAR_HDR_SIZE        16
+#define WEAR_COPY_BLOCKS(n)  DIV_ROUND_UP(WEAR_HDR_SIZE + 2 * (n), FLASH_SECTOR_SIZE)
+#else
+#define WEAR_COPY_BLOCKS(n)  0
+#endif
+#define FLASH1_WEAR_BLOCK    (FLASH1_BLOCKS - 2 * WEAR_COPY_BLOCKS(FLASH1_BLOCKS))
+#define FLASH2_WEAR_BLOCK    (FLASH2_BLOCKS - 2 * WEAR_COPY_BLOCKS(FLASH2_BLOCKS))
+#define FLASH1_RAW_BLOCKS    (FLASH1_RAW_KB * 1024 / FLASH_SECTOR_SIZE)
+#define FLASH2_RAW_BLOCKS    (FLASH2_RAW_KB * 1024 / FLASH_SECTOR_SIZE)
+#define FLASH1_LFS_BLOCKS    (FLASH1_WEAR_BLOCK - FLASH1_RAW_BLOCKS)
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+#define RAWLOG_SEG_SIZE      FLASH_BLOCK_SIZE_64K
+#define RAWLOG_SEG_BLOCKS    (RAWLOG_SEG_SIZE / FLASH_SECTOR_SIZE)
+#define RAWLOG_END_BLOCK     (FLASH2_WEAR_BLOCK / RAWLOG_SEG_BLOCKS * RAWLOG_SEG_BLOCKS)
+#define RAWLOG_FIRST_BLOCK   (RAWLOG_END_BLOCK - NOR_FLASH_RAWLOG_SEGMENTS * RAWLOG_SEG_BLOCKS)
+#define FLASH2_LFS_BLOCKS    (RAWLOG_FIRST_BLOCK - FLASH2_RAW_BLOCKS)
+#else
+#define FLASH2_LFS_BLOCKS    (FLASH2_WEAR_BLOCK - FLASH2_RAW_BLOCKS)
+#endif
 
 /* LittleFS configs */
 static struct lfs_config lfs_cfg1 = {
     .read = lfs1_read, .prog = lfs1_prog, .erase = lfs1_erase, .sync = lfs1_sync,
-    .block_size = FLASH_SECTOR_SIZE, .block_count = FLASH1_CHIP_SIZE_BYTES / FLASH_SECTOR_SIZE,
-    .cache_size = FLASH_PAGE_SIZE, .lookahead_size = 256, .block_cycles = 100000,
-    .read_size = FLASH_PAGE_SIZE, .prog_size = FLASH_PAGE_SIZE,
+    .lock = lfs_lock_cb, .unlock = lfs_unlock_cb, .context = &lfs1_lock,
+    .block_size = FLASH_SECTOR_SIZE, .block_count = FLASH1_LFS_BLOCKS,
+    .cache_size = FLASH1_LFS_CACHE_SIZE, .lookahead_size = FLASH1_LFS_LOOKAHEAD_SIZE,
+    .block_cycles = FLASH1_LFS_BLOCK_CYCLES,
+    .read_size = FLASH1_LFS_READ_SIZE, .prog_size = FLASH1_LFS_PROG_SIZE,
+    .metadata_max = FLASH1_LFS_METADATA_MAX,
 };
 
 static struct lfs_config lfs_cfg2 = {
     .read = lfs2_read, .prog = lfs2_prog, .erase = lfs2_erase, .sync = lfs2_sync,
-    .block_size = FLASH_SECTOR_SIZE, .block_count = FLASH2_CHIP_SIZE_BYTES / FLASH_SECTOR_SIZE,
-    .cache_size = FLASH_PAGE_SIZE, .lookahead_size = 256, .block_cycles = 100000,
-    .read_size = FLASH_PAGE_SIZE, .prog_size = FLASH_PAGE_SIZE,
+    .lock = lfs_lock_cb, .unlock = lfs_unlock_cb, .context = &lfs2_lock,
+    .block_size = FLASH_SECTOR_SIZE, .block_count = FLASH2_LFS_BLOCKS,
+    .cache_size = FLASH2_LFS_CACHE_SIZE, .lookahead_size = FLASH2_LFS_LOOKAHEAD_SIZE,
+    .block_cycles = FLASH2_LFS_BLOCK_CYCLES,
+    .read_size = FLASH2_LFS_READ_SIZE, .prog_size = FLASH2_LFS_PROG_SIZE,
+    .metadata_max = FLASH2_LFS_METADATA_MAX,
 };
 
 /*============================================================================
  * FLASH1 - Custom SPI Driver
  *============================================================================*/
 
+/*
+ * Single SPI transaction: the command bytes are clocked out while the
+ * matching RX bytes are skipped (NULL buffer), then rx_len bytes are read
+ * back. CS is driven by the SPI controller from the devicetree cs-gpios
+ * entry, so the whole operation is one driver round-trip.
+ */
 static int flash1_transceive(const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
 {
+    struct spi_buf tx_buf = {.buf = (void *)tx, .len = tx_len};
+    struct spi_buf rx_bufs[2] = {
+        {.buf = NULL, .len = tx_len},
+        {.buf = rx, .len = rx_len},
+    };
+    struct spi_buf_set tx_set = {.buffers = &tx_buf, .count = 1};
+    struct spi_buf_set rx_set = {.buffers = rx_bufs, .count = 2};
+    bool has_rx = (rx != NULL && rx_len > 0);
     int ret;
     
-    gpio_pin_set(flash1.gpio_dev, flash1.cs_pin, 0);
-    k_busy_wait(10);
+    ret = spi_transceive(flash1.spi_dev, &flash1.spi_cfg, &tx_set, has_rx ? &rx_set : NULL);
+    if (ret != 0) {
+        LOG_ERR("SPI transceive failed: %d", ret);
+    }
+    return ret;
+}
+
+/* Command header and payload sent as two spi_bufs of one TX-only transaction,
+ * so the payload goes to the bus straight from the caller's buffer */
+static int flash1_write_cmd(const uint8_t *hdr, size_t hdr_len, const void *data, size_t len)
+{
+    struct spi_buf tx_bufs[2] = {
+        {.buf = (void *)hdr, .len = hdr_len},
+        {.buf = (void *)data, .len = len},
+    };
+    struct spi_buf_set tx_set = {.buffers = tx_bufs, .count = 2};
     
-    if (tx_len > 0) {
-        struct spi_buf tx_buf = {.buf = (void *)tx, .len = tx_len};
-        struct spi_buf_set tx_set = {.buffers = &tx_buf, .count = 1};
-        ret = spi_write(flash1.spi_dev, &flash1.spi_cfg, &tx_set);
-        if (ret != 0) {
-            LOG_ERR("SPI write failed: %d", ret);
-            gpio_pin_set(flash1.gpio_dev, flash1.cs_pin, 1);
-            return ret;
-        }
+    int ret = spi_write(flash1.spi_dev, &flash1.spi_cfg, &tx_set);
+    if (ret != 0) {
+        LOG_ERR("SPI write failed: %d", ret);
+    }
+    return ret;
+}
+
+/*
+ * Lock helpers. Readers announce themselves before taking the lock so an
+ * erase holding it can suspend; writers wait until a suspended erase resumes.
+ */
+static void flash1_lock_read(void)
+{
+    atomic_inc(&flash1.read_pending);
+    k_sem_give(&flash1.read_kick);
+    k_mutex_lock(&flash1.lock, K_FOREVER);
+}
+
+static void flash1_unlock_read(void)
+{
+    if (atomic_dec(&flash1.read_pending) == 1) {
+        k_condvar_signal(&flash1.reads_done);
+    }
+    k_mutex_unlock(&flash1.lock);
+}
+
+static void flash1_lock_write(void)
+{
+    k_mutex_lock(&flash1.lock, K_FOREVER);
+    while (flash1.erase_suspended) {
+        k_condvar_wait(&flash1.resumed, &flash1.lock, K_FOREVER);
     }
+}
+
+/*
+ * Called with the lock held while an erase is busy and readers are pending.
+ * Suspends the erase, hands the lock to the readers until none are left,
+ * then resumes. If the erase finished before it could be suspended the
+ * caller's next status poll sees it idle.
+ */
+static int flash1_suspend_for_reads(void)
+{
+    uint8_t cmd = CMD_SUSPEND;
+    uint8_t scur;
     
-    if (rx != NULL && rx_len > 0) {
-        struct spi_buf rx_buf = {.buf = rx, .len = rx_len};
-        struct spi_buf_set rx_set = {.buffers = &rx_buf, .count = 1};
-        ret = spi_read(flash1.spi_dev, &flash1.spi_cfg, &rx_set);
-        if (ret != 0) {
-            LOG_ERR("SPI read failed: %d", ret);
-            gpio_pin_set(flash1.gpio_dev, flash1.cs_pin, 1);
-            return ret;
-        }
+    if (flash1_transceive(&cmd, 1, NULL, 0) != 0) return -EIO;
+    k_busy_wait(FLASH1_TESL_US);
+    
+    cmd = CMD_READ_SECURITY;
+    if (flash1_transceive(&cmd, 1, &scur, 1) != 0) return -EIO;
+    if (!(scur & SCUR_ESB)) return 0;
+    
+    flash1.erase_suspended = true;
+    while (atomic_get(&flash1.read_pending) > 0) {
+        k_condvar_wait(&flash1.reads_done, &flash1.lock, K_FOREVER);
     }
+    flash1.erase_suspended = false;
     
-    k_busy_wait(10);
-    gpio_pin_set(flash1.gpio_dev, flash1.cs_pin, 1);
-    return 0;
+    cmd = CMD_RESUME;
+    int ret = flash1_transceive(&cmd, 1, NULL, 0);
+    k_condvar_broadcast(&flash1.resumed);
+    return ret;
 }
 
-static int flash1_wait_ready(void)
+static int flash1_wait_ready(enum flash1_wait_op op)
 {
+    const struct flash1_wait_profile *p = &flash1_wait_profiles[op];
+    bool suspendable = FLASH1_ERASE_SUSPEND &&
+                       op >= FLASH1_WAIT_ERASE_4K && op <= FLASH1_WAIT_ERASE_64K;
+    uint32_t start = k_cycle_get_32();
+    uint32_t resumed_at = start;
+    uint32_t backoff = p->backoff_us;
     uint8_t status;
-    for (int i = 0; i < 1000; i++) {
+    
+    while (true) {
         if (flash1_read_status(&status) != 0) return -EIO;
         if (!(status & SR_BUSY)) return 0;
-        k_msleep(1);
+        
+        uint32_t now = k_cycle_get_32();
+        uint64_t elapsed_us = k_cyc_to_us_floor64(now - start);
+        if (elapsed_us >= (uint64_t)p->timeout_ms * 1000U) {
+            LOG_ERR("Flash1: Busy timeout after %u ms (op %d)", p->timeout_ms, op);
+            return -ETIMEDOUT;
+        }
+        
+        if (suspendable && atomic_get(&flash1.read_pending) > 0) {
+            uint64_t since_resume = k_cyc_to_us_floor64(now - resumed_at);
+            if (since_resume < FLASH1_TERS_US) {
+                /* The reader's kick is spent: sleep out tERS, not a back-off */
+                k_usleep(FLASH1_TERS_US - since_resume);
+                continue;
+            }
+            if (flash1_suspend_for_reads() != 0) return -EIO;
+            /* Time spent suspended doesn't count towards the timeout */
+            resumed_at = k_cycle_get_32();
+            start += resumed_at - now;
+            continue;
+        }
+        
+        if (elapsed_us < p->spin_us) {
+            k_busy_wait(FLASH1_SPIN_POLL_US);
+        } else if (suspendable) {
+            k_sem_take(&flash1.read_kick, K_USEC(backoff));
+            backoff = MIN(backoff * 2, p->backoff_max_us);
+        } else {
+            k_usleep(backoff);
+            backoff = MIN(backoff * 2, p->backoff_max_us);
+        }
     }
-    return -ETIMEDOUT;
+}
+
+/*
+ * Build opcode + address header. Parts above 16MB use the dedicated 4-byte
+ * opcodes (stateless, unlike EN4B, so a reset can't leave the chip in the
+ * wrong mode). Returns the header length.
+ */
+static size_t flash1_cmd_addr(uint8_t *cmd, uint8_t opcode, uint8_t opcode_4b, uint32_t addr)
+{
+#if FLASH1_ADDR_4B
+    cmd[0] = opcode_4b;
+    sys_put_be32(addr, &cmd[1]);
+    return 5;
+#else
+    ARG_UNUSED(opcode_4b);
+    cmd[0] = opcode;
+    sys_put_be24(addr, &cmd[1]);
+    return 4;
+#endif
 }
 
 static int flash1_read_status(uint8_t *status)
@@ -160,17 +563,66 @@ static int flash1_read_id(uint8_t *id)
     return flash1_transceive(tx, 1, id, 3);
 }
 
+/*
+ * Reads of any length. The data phase is split into DMA-sized spi_bufs that
+ * all go out in one transaction (one CS assertion); only bursts longer than
+ * FLASH1_READ_MAX_CHUNKS chunks re-issue the read command.
+ */
 static int flash1_read_data(uint32_t addr, void *buf, size_t size)
 {
-    if (size > 512) return -EINVAL;
+    const struct flash1_read_mode *mode = flash1.read_mode;
+    uint8_t *dst = buf;
     
-    uint8_t cmd[4] = {
-        CMD_READ_DATA,
-        (addr >> 16) & 0xFF,
-        (addr >> 8) & 0xFF,
-        addr & 0xFF
-    };
-    return flash1_transceive(cmd, 4, buf, size);
+    while (size > 0) {
+        /* Opcode, 3/4 address bytes, then dummy bytes (don't-care, sent as 0) */
+        uint8_t cmd[6] = {0};
+        size_t cmd_len = flash1_cmd_addr(cmd, mode->opcode, mode->opcode_4b, addr);
+        cmd_len += mode->dummy_bytes;
+        struct spi_buf tx_buf = {.buf = cmd, .len = cmd_len};
+        struct spi_buf rx_bufs[1 + FLASH1_READ_MAX_CHUNKS];
+        size_t count = 0;
+        size_t burst = 0;
+        
+        rx_bufs[count++] = (struct spi_buf){.buf = NULL, .len = cmd_len};
+        while (burst < size && count < ARRAY_SIZE(rx_bufs)) {
+            size_t len = MIN(size - burst, FLASH1_READ_CHUNK_SIZE);
+            rx_bufs[count++] = (struct spi_buf){.buf = dst + burst, .len = len};
+            burst += len;
+        }
+        
+        struct spi_buf_set tx_set = {.buffers = &tx_buf, .count = 1};
+        struct spi_buf_set rx_set = {.buffers = rx_bufs, .count = count};
+        flash1_lock_read();
+        int ret = spi_transceive(flash1.spi_dev, &flash1.spi_cfg, &tx_set, &rx_set);
+        flash1_unlock_read();
+        if (ret != 0) {
+            LOG_ERR("SPI read failed: %d", ret);
+            return ret;
+        }
+        
+        addr += burst;
+        dst += burst;
+        size -= burst;
+    }
+    return 0;
+}
+
+/* One WREN + PP + busy-wait sequence; the lock is held per page so reads
+ * from other threads can slot in between pages of a long write */
+static int flash1_prog_page(uint32_t addr, const uint8_t *data, size_t write_size)
+{
+    uint8_t hdr[5];
+    size_t hdr_len = flash1_cmd_addr(hdr, CMD_PAGE_PROGRAM, CMD_PAGE_PROGRAM_4B, addr);
+    int ret = -EIO;
+    
+    flash1_lock_write();
+    if (flash1_write_enable() == 0 &&
+        flash1_write_cmd(hdr, hdr_len, data, write_size) == 0 &&
+        flash1_wait_ready(FLASH1_WAIT_PROGRAM) == 0) {
+        ret = 0;
+    }
+    k_mutex_unlock(&flash1.lock);
+    return ret;
 }
 
 static int flash1_prog_data(uint32_t addr, const void *buf, size_t size)
@@ -180,17 +632,7 @@ static int flash1_prog_data(uint32_t addr, const void *buf, size_t size)
         uint32_t page_off = addr % FLASH_PAGE_SIZE;
         size_t write_size = MIN(size, FLASH_PAGE_SIZE - page_off);
         
-        if (flash1_write_enable() != 0) return -EIO;
-        
-        uint8_t cmd[4 + 256];
-        cmd[0] = CMD_PAGE_PROGRAM;
-        cmd[1] = (addr >> 16) & 0xFF;
-        cmd[2] = (addr >> 8) & 0xFF;
-        cmd[3] = addr & 0xFF;
-        memcpy(cmd + 4, data, write_size);
-        
-        if (flash1_transceive(cmd, 4 + write_size, NULL, 0) != 0) return -EIO;
-        if (flash1_wait_ready() != 0) return -EIO;
+        if (flash1_prog_page(addr, data, write_size) != 0) return -EIO;
         
         addr += write_size;
         data += write_size;
@@ -199,12 +641,101 @@ static int flash1_prog_data(uint32_t addr, const void *buf, size_t size)
     return 0;
 }
 
+/* WREN + erase command + busy-wait. Chip erase is sent without an address */
+static int flash1_erase_cmd(uint8_t opcode, uint8_t opcode_4b, uint32_t addr, enum flash1_wait_op op)
+{
+    uint8_t cmd[5] = {opcode};
+    size_t cmd_len = (op == FLASH1_WAIT_ERASE_CHIP) ? 1 : flash1_cmd_addr(cmd, opcode, opcode_4b, addr);
+    int ret = -EIO;
+    
+    flash1_lock_write();
+    if (flash1_write_enable() == 0 && flash1_transceive(cmd, cmd_len, NULL, 0) == 0) {
+        ret = flash1_wait_ready(op);
+    }
+    k_mutex_unlock(&flash1.lock);
+    return ret;
+}
+
 static int flash1_erase_sector(uint32_t addr)
 {
-    if (flash1_write_enable() != 0) return -EIO;
-    uint8_t cmd[4] = {CMD_SECTOR_ERASE, (addr >> 16) & 0xFF, (addr >> 8) & 0xFF, addr & 0xFF};
-    if (flash1_transceive(cmd, 4, NULL, 0) != 0) return -EIO;
-    return flash1_wait_ready();
+    return flash1_erase_cmd(CMD_SECTOR_ERASE, CMD_SECTOR_ERASE_4B, addr, FLASH1_WAIT_ERASE_4K);
+}
+
+/* Erase a 4KB-aligned range with the largest erase command each step allows */
+static int flash1_erase_range(uint32_t addr, size_t len)
+{
+    if (addr == 0 && len == flash1.size_bytes) {
+        LOG_INF("%s: Chip erase", flash1.name);
+        return flash1_erase_cmd(CMD_CHIP_ERASE, CMD_CHIP_ERASE, 0, FLASH1_WAIT_ERASE_CHIP);
+    }
+    
+    while (len > 0) {
+        int ret;
+        size_t step;
+        
+        if ((addr % FLASH_BLOCK_SIZE_64K) == 0 && len >= FLASH_BLOCK_SIZE_64K) {
+            step = FLASH_BLOCK_SIZE_64K;
+            ret = flash1_erase_cmd(CMD_BLOCK_ERASE_64K, CMD_BLOCK_ERASE_64K_4B, addr, FLASH1_WAIT_ERASE_64K);
+        } else if ((addr % FLASH_BLOCK_SIZE_32K) == 0 && len >= FLASH_BLOCK_SIZE_32K) {
+            step = FLASH_BLOCK_SIZE_32K;
+            ret = flash1_erase_cmd(CMD_BLOCK_ERASE_32K, CMD_BLOCK_ERASE_32K_4B, addr, FLASH1_WAIT_ERASE_32K);
+        } else {
+            step = FLASH_SECTOR_SIZE;
+            ret = flash1_erase_sector(addr);
+        }
+        if (ret != 0) return ret;
+        
+        addr += step;
+        len -= step;
+    }
+    return 0;
+}
+
+/* RDSFDP always uses 3 address bytes and 8 dummy cycles */
+static int flash1_read_sfdp(uint32_t addr, void *buf, size_t size)
+{
+    uint8_t cmd[5] = {CMD_READ_SFDP, (addr >> 16) & 0xFF, (addr >> 8) & 0xFF, addr & 0xFF, 0};
+    return flash1_transceive(cmd, sizeof(cmd), buf, size);
+}
+
+/*
+ * Pick the read engine. FLASH1_READ_MODE forces one; in auto mode Fast Read
+ * is used when the part exposes a valid SFDP Basic Flash Parameter Table
+ * (JESD216 makes 1-1-1 Fast Read mandatory for SFDP parts). Quad reads are
+ * only reported: SPI1 is a single-lane SPIM, IO2/IO3 are plain GPIOs.
+ */
+static void flash1_select_read_mode(void)
+{
+    int mode = FLASH1_READ_MODE;
+    
+    if (mode == FLASH1_READ_MODE_AUTO) {
+        uint8_t hdr[16];
+        mode = FLASH1_READ_MODE_NORMAL;
+        
+        /* 0x0B only pays for its dummy byte when the bus runs faster than 0x03 allows */
+        if (FLASH1_BUS_MAX_FREQ <= flash1_read_modes[FLASH1_READ_MODE_NORMAL].max_freq) {
+            LOG_INF("%s: Bus limit %u Hz is within normal read", flash1.name, (uint32_t)FLASH1_BUS_MAX_FREQ);
+        } else if (flash1_read_sfdp(0, hdr, sizeof(hdr)) == 0 &&
+                   sys_get_le32(&hdr[0]) == SFDP_SIGNATURE && hdr[8] == 0x00) {
+            uint32_t bfpt_addr = sys_get_le24(&hdr[12]);
+            uint8_t dw1[4];
+            
+            mode = FLASH1_READ_MODE_FAST;
+            if (flash1_read_sfdp(bfpt_addr, dw1, sizeof(dw1)) == 0) {
+                uint32_t caps = sys_get_le32(dw1);
+                LOG_INF("%s: SFDP quad read 1-1-4:%s 1-4-4:%s (unused on SPIM)", flash1.name,
+                        (caps & SFDP_BFPT_114_READ) ? "yes" : "no",
+                        (caps & SFDP_BFPT_144_READ) ? "yes" : "no");
+            }
+        } else {
+            LOG_WRN("%s: No SFDP table, using normal read", flash1.name);
+        }
+    }
+    
+    flash1.read_mode = &flash1_read_modes[mode];
+    flash1.spi_cfg.frequency = MIN(flash1.read_mode->max_freq, FLASH1_BUS_MAX_FREQ);
+    LOG_INF("%s: Read mode %s, SPI clock %u Hz", flash1.name, flash1.read_mode->name,
+            flash1.spi_cfg.frequency);
 }
 
 /* Initialize Flash1 (SPI) */
@@ -213,7 +744,10 @@ static int flash1_init(void)
     flash1.name = FLASH1_CHIP_NAME;
     flash1.size_bytes = FLASH1_CHIP_SIZE_BYTES;
     flash1.jedec_id = FLASH1_CHIP_JEDEC_ID;
-    flash1.cs_pin = 4;  /* P0.04 */
+    k_mutex_init(&flash1.lock);
+    k_sem_init(&flash1.read_kick, 0, 1);
+    k_condvar_init(&flash1.reads_done);
+    k_condvar_init(&flash1.resumed);
     
     flash1.spi_dev = DEVICE_DT_GET(DT_NODELABEL(spi1));
     if (!device_is_ready(flash1.spi_dev)) {
@@ -221,17 +755,18 @@ static int flash1_init(void)
         return -ENODEV;
     }
     
-    flash1.gpio_dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
-    if (!device_is_ready(flash1.gpio_dev)) {
-        LOG_ERR("Flash1: GPIO device not ready");
-        return -ENODEV;
-    }
-    
+    /* CS (P0.04) comes from spi1 cs-gpios and is toggled by the SPI driver.
+     * Probe at 8MHz; the clock is raised once the read mode is known. */
     flash1.spi_cfg.frequency = 8000000;  /* 8MHz */
+    flash1.read_mode = &flash1_read_modes[FLASH1_READ_MODE_NORMAL];
     flash1.spi_cfg.operation = SPI_WORD_SET(8) | SPI_TRANSFER_MSB | SPI_OP_MODE_MASTER;
     flash1.spi_cfg.slave = 0;
+    flash1.spi_cfg.cs = (struct spi_cs_control)SPI_CS_CONTROL_INIT(DT_NODELABEL(mx25l12845g), 0);
     
-    gpio_pin_configure(flash1.gpio_dev, flash1.cs_pin, GPIO_OUTPUT_HIGH);
+    if (!gpio_is_ready_dt(&flash1.spi_cfg.cs.gpio)) {
+        LOG_ERR("Flash1: CS GPIO not ready");
+        return -ENODEV;
+    }
     k_msleep(10);
     
     /* Wake from deep power-down */
@@ -256,8 +791,11 @@ static int flash1_init(void)
         }
     }
     
+    flash1_select_read_mode();
+    
     flash1.initialized = true;
-    LOG_INF("%s: Initialized (%d MB)", flash1.name, flash1.size_bytes / (1024*1024));
+    LOG_INF("%s: Initialized (%d MB, %d-byte addressing)", flash1.name,
+            flash1.size_bytes / (1024*1024), FLASH1_ADDR_4B ? 4 : 3);
     return 0;
 }
 
@@ -291,172 +829,1526 @@ static int flash2_init(void)
 }
 
 /*============================================================================
- * LittleFS Callbacks - Flash1 (SPI)
+ * Operation Statistics - counted at the LittleFS callback level
+ *
+ * Callbacks already run under the device's fs lock, so updates need no extra
+ * locking. With CONFIG_TIMING_FUNCTIONS timing uses the timing API (a
+ * hardware timer on nRF52, running from nor_flash_system_mount() until
+ * System OFF), which resolves short reads and page programs. Without it the
+ * kernel cycle counter is used: the 32kHz RTC on nRF52, ~31us resolution.
  *============================================================================*/
 
-static int lfs1_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buf, lfs_size_t size)
+static struct nor_flash_stats lfs1_stats, lfs2_stats;
+
+#if NOR_FLASH_STATS && defined(CONFIG_TIMING_FUNCTIONS)
+typedef timing_t stats_time_t;
+#else
+typedef uint32_t stats_time_t;
+#endif
+
+static inline stats_time_t stats_start(void)
 {
-    uint32_t addr = (block * FLASH_SECTOR_SIZE) + off;
-    return flash1_read_data(addr, buf, size) == 0 ? LFS_ERR_OK : LFS_ERR_IO;
+#if NOR_FLASH_STATS && defined(CONFIG_TIMING_FUNCTIONS)
+    return timing_counter_get();
+#elif NOR_FLASH_STATS
+    return k_cycle_get_32();
+#else
+    return 0;
+#endif
 }
 
-static int lfs1_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buf, lfs_size_t size)
+static inline void stats_record(struct nor_flash_stats *st, enum nor_flash_op op,
+                                size_t bytes, stats_time_t start, int err)
 {
-    uint32_t addr = (block * FLASH_SECTOR_SIZE) + off;
-    return flash1_prog_data(addr, buf, size) == 0 ? LFS_ERR_OK : LFS_ERR_IO;
+#if NOR_FLASH_STATS
+    struct nor_flash_op_stats *s = &st->op[op];
+#ifdef CONFIG_TIMING_FUNCTIONS
+    stats_time_t end = timing_counter_get();
+    uint32_t us = (uint32_t)(timing_cycles_to_ns(timing_cycles_get(&start, &end)) / 1000);
+#else
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+#endif
+    
+    s->count++;
+    s->errors += (err != 0);
+    s->bytes += bytes;
+    s->total_us += us;
+    if (s->count == 1 || us < s->min_us) s->min_us = us;
+    if (us > s->max_us) s->max_us = us;
+    s->hist[MIN(us ? 32 - __builtin_clz(us) : 0, NOR_FLASH_STATS_BUCKETS - 1)]++;
+#endif
 }
 
-static int lfs1_erase(const struct lfs_config *c, lfs_block_t block)
+/* LittleFS event hook (LFS_EVENT_HOOK in CMakeLists.txt), called with the fs lock held */
+void nor_flash_lfs_event(const struct lfs_config *cfg, int event)
 {
-    uint32_t addr = block * FLASH_SECTOR_SIZE;
-    return flash1_erase_sector(addr) == 0 ? LFS_ERR_OK : LFS_ERR_IO;
+#if NOR_FLASH_STATS
+    struct nor_flash_stats *st = (cfg == &lfs_cfg1) ? &lfs1_stats : &lfs2_stats;
+    if (event == LFS_EVENT_COMPACT) {
+        st->compactions++;
+    } else if (event == LFS_EVENT_RELOCATE) {
+        st->relocations++;
+    }
+#endif
 }
 
-static int lfs1_sync(const struct lfs_config *c) { return LFS_ERR_OK; }
-
 /*============================================================================
- * LittleFS Callbacks - Flash2 (QSPI via Zephyr API)
+ * Wear Telemetry - per-block erase counts, written back in batches
+ *
+ * RAM holds a 4-bit pending count per block. The stored table (uint16 per
+ * block, saturating) has two copies at the top of the device, each a header
+ * followed by the table. A write-back streams the current copy plus the
+ * pending counts into the other copy and commits it by writing the header
+ * last, so a power loss leaves the previous copy intact; the pending counts
+ * are only dropped once the new copy is committed. Write-backs run on their
+ * own low-priority work queue when a batch is due, and on demand through
+ * nor_flash_wear_flush().
  *============================================================================*/
 
-static int lfs2_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buf, lfs_size_t size)
+#if NOR_FLASH_WEAR_TRACK
+#define WEAR_MAGIC   0x57454152  /* "WEAR" */
+#define WEAR_CHUNK   128         /* Blocks per streamed chunk */
+
+struct wear_hdr {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t blocks;
+    uint32_t crc;                /* Over the table */
+};
+
+struct wear_state {
+    uint8_t *pending;            /* 4 bits per block */
+    uint32_t blocks;
+    uint32_t pending_total;
+    uint32_t lost;
+    bool due;                    /* Batch full or a counter saturated */
+    int cur;                     /* Current stored copy, -1 if none */
+    uint32_t seq;
+};
+
+static uint8_t wear1_pending[DIV_ROUND_UP(FLASH1_BLOCKS, 2)];
+static uint8_t wear2_pending[DIV_ROUND_UP(FLASH2_BLOCKS, 2)];
+static struct wear_state wear1 = {.pending = wear1_pending, .blocks = FLASH1_BLOCKS, .cur = -1};
+static struct wear_state wear2 = {.pending = wear2_pending, .blocks = FLASH2_BLOCKS, .cur = -1};
+static struct k_spinlock wear_lock;       /* Pending counts, updated from any context */
+static K_MUTEX_DEFINE(wear_flush_lock);   /* wear_buf and the stored copies */
+static uint16_t wear_buf[WEAR_CHUNK], wear_old_buf[WEAR_CHUNK];
+
+static K_THREAD_STACK_DEFINE(wear_work_stack, NOR_FLASH_WEAR_STACK_SIZE);
+static struct k_work_q wear_work_q;
+static void wear_flush_work_handler(struct k_work *work);
+static K_WORK_DEFINE(wear_flush_work, wear_flush_work_handler);
+
+static uint32_t wear_copy_addr(flash_device_t device, int copy)
 {
-    uint32_t addr = (block * FLASH_SECTOR_SIZE) + off;
-    int ret = flash_read(flash2_dev, addr, buf, size);
-    return (ret == 0) ? LFS_ERR_OK : LFS_ERR_IO;
+    if (device == FLASH1) {
+        return (FLASH1_WEAR_BLOCK + copy * WEAR_COPY_BLOCKS(FLASH1_BLOCKS)) * FLASH_SECTOR_SIZE;
+    }
+    return (FLASH2_WEAR_BLOCK + copy * WEAR_COPY_BLOCKS(FLASH2_BLOCKS)) * FLASH_SECTOR_SIZE;
 }
 
-static int lfs2_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buf, lfs_size_t size)
+/* Count an erase of blocks [first, first + count) */
+static void wear_note_erase(flash_device_t device, lfs_block_t first, lfs_block_t count)
 {
-    uint32_t addr = (block * FLASH_SECTOR_SIZE) + off;
-    int ret = flash_write(flash2_dev, addr, buf, size);
-    return (ret == 0) ? LFS_ERR_OK : LFS_ERR_IO;
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+    k_spinlock_key_t key = k_spin_lock(&wear_lock);
+    
+    for (lfs_block_t b = first; b < first + count && b < w->blocks; b++) {
+        uint8_t shift = (b & 1) * 4;
+        uint8_t n = (w->pending[b / 2] >> shift) & 0xF;
+        if (n == 0xF) {
+            w->lost++;
+            continue;
+        }
+        w->pending[b / 2] += 1 << shift;
+        w->pending_total++;
+        if (n + 1 == 0xF) w->due = true;
+    }
+    if (w->pending_total >= NOR_FLASH_WEAR_BATCH) w->due = true;
+    bool due = w->due;
+    k_spin_unlock(&wear_lock, key);
+    
+    /* -ENODEV until nor_flash_system_start() starts the queue; it checks again */
+    if (due) k_work_submit_to_queue(&wear_work_q, &wear_flush_work);
 }
 
-static int lfs2_erase(const struct lfs_config *c, lfs_block_t block)
+/* Add the pending counts of a chunk to table[] */
+static void wear_merge_pending(struct wear_state *w, lfs_block_t first, size_t count, uint16_t *table)
 {
-    uint32_t addr = block * FLASH_SECTOR_SIZE;
-    int ret = flash_erase(flash2_dev, addr, FLASH_SECTOR_SIZE);
-    return (ret == 0) ? LFS_ERR_OK : LFS_ERR_IO;
+    k_spinlock_key_t key = k_spin_lock(&wear_lock);
+    
+    for (size_t i = 0; i < count; i++) {
+        lfs_block_t b = first + i;
+        uint8_t n = (w->pending[b / 2] >> ((b & 1) * 4)) & 0xF;
+        table[i] = MIN((uint32_t)table[i] + n, UINT16_MAX);
+    }
+    k_spin_unlock(&wear_lock, key);
 }
 
-static int lfs2_sync(const struct lfs_config *c) { return LFS_ERR_OK; }
+/*
+ * Drop the counts a committed copy now holds (new - old per block) from the
+ * pending ones; erases noted during the write-back stay pending. A saturated
+ * counter can't take more, so its pending count goes as well.
+ */
+static void wear_take_pending(struct wear_state *w, lfs_block_t first, size_t count,
+                              const uint16_t *old, const uint16_t *new)
+{
+    k_spinlock_key_t key = k_spin_lock(&wear_lock);
+    
+    for (size_t i = 0; i < count; i++) {
+        lfs_block_t b = first + i;
+        uint8_t shift = (b & 1) * 4;
+        uint8_t n = (w->pending[b / 2] >> shift) & 0xF;
+        uint8_t take = (new[i] == UINT16_MAX) ? n : MIN(n, (uint32_t)(new[i] - old[i]));
+        w->pending[b / 2] -= take << shift;
+        w->pending_total -= take;
+    }
+    k_spin_unlock(&wear_lock, key);
+}
 
-/*============================================================================
- * LittleFS Mount
- *============================================================================*/
+static int wear_read(flash_device_t device, uint32_t addr, void *buf, size_t len)
+{
+    return (device == FLASH1) ? flash1_read_data(addr, buf, len) : flash_read(flash2_dev, addr, buf, len);
+}
 
-static int lfs_init_mount(lfs_t *lfs, struct lfs_config *cfg, const char *name)
+static int wear_prog(flash_device_t device, uint32_t addr, const void *buf, size_t len)
 {
-    int ret = lfs_mount(lfs, cfg);
-    if (ret == LFS_ERR_OK) {
-        LOG_INF("%s: LittleFS mounted", name);
+    return (device == FLASH1) ? flash1_prog_data(addr, buf, len) : flash_write(flash2_dev, addr, buf, len);
+}
+
+/* Load a chunk of a stored table copy into buf (zeros if copy < 0, none) */
+static int wear_read_chunk(flash_device_t device, int copy, lfs_block_t first, size_t count, uint16_t *buf)
+{
+    if (copy < 0) {
+        memset(buf, 0, count * sizeof(buf[0]));
         return 0;
     }
+    return wear_read(device, wear_copy_addr(device, copy) + WEAR_HDR_SIZE + first * sizeof(buf[0]),
+                     buf, count * sizeof(buf[0]));
+}
+
+/* Pick the newest stored copy whose table matches its CRC */
+static void wear_load(flash_device_t device)
+{
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+    struct wear_hdr hdr[2];
+    bool ok[2];
     
-    LOG_WRN("%s: Mount failed (%d), formatting...", name, ret);
-    ret = lfs_format(lfs, cfg);
-    if (ret != LFS_ERR_OK) {
-        LOG_ERR("%s: Format failed (%d)", name, ret);
-        return -EIO;
+    k_mutex_lock(&wear_flush_lock, K_FOREVER);
+    for (int copy = 0; copy < 2; copy++) {
+        ok[copy] = wear_read(device, wear_copy_addr(device, copy), &hdr[copy], sizeof(hdr[copy])) == 0 &&
+                   hdr[copy].magic == WEAR_MAGIC && hdr[copy].blocks == w->blocks;
+        
+        uint32_t crc = 0xFFFFFFFF;
+        for (lfs_block_t b = 0; ok[copy] && b < w->blocks; b += WEAR_CHUNK) {
+            size_t n = MIN(WEAR_CHUNK, w->blocks - b);
+            ok[copy] = (wear_read_chunk(device, copy, b, n, wear_buf) == 0);
+            crc = lfs_crc(crc, wear_buf, n * sizeof(wear_buf[0]));
+        }
+        ok[copy] = ok[copy] && (crc == hdr[copy].crc);
     }
     
-    ret = lfs_mount(lfs, cfg);
-    if (ret != LFS_ERR_OK) {
-        LOG_ERR("%s: Mount after format failed (%d)", name, ret);
+    if (ok[0] && (!ok[1] || (int32_t)(hdr[0].seq - hdr[1].seq) > 0)) {
+        w->cur = 0;
+    } else {
+        w->cur = ok[1] ? 1 : -1;
+    }
+    w->seq = (w->cur >= 0) ? hdr[w->cur].seq : 0;
+    k_mutex_unlock(&wear_flush_lock);
+    
+    LOG_INF("FLASH%d: Wear table %s (seq %u)", device + 1, (w->cur >= 0) ? "loaded" : "empty", w->seq);
+}
+
+/* Stream current copy + pending counts into the other copy, header last */
+static int wear_flush(flash_device_t device)
+{
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+    lfs_block_t copy_blocks = (device == FLASH1) ? WEAR_COPY_BLOCKS(FLASH1_BLOCKS) : WEAR_COPY_BLOCKS(FLASH2_BLOCKS);
+    
+    k_mutex_lock(&wear_flush_lock, K_FOREVER);
+    int next = (w->cur == 0) ? 1 : 0;
+    uint32_t base = wear_copy_addr(device, next);
+    uint32_t crc = 0xFFFFFFFF;
+    
+    w->due = false;
+    int ret = (device == FLASH1) ? flash1_erase_range(base, copy_blocks * FLASH_SECTOR_SIZE)
+                                 : flash_erase(flash2_dev, base, copy_blocks * FLASH_SECTOR_SIZE);
+    bool erased = (ret == 0);
+    
+    for (lfs_block_t b = 0; ret == 0 && b < w->blocks; b += WEAR_CHUNK) {
+        size_t n = MIN(WEAR_CHUNK, w->blocks - b);
+        ret = wear_read_chunk(device, w->cur, b, n, wear_buf);
+        if (ret != 0) break;
+        wear_merge_pending(w, b, n, wear_buf);
+        crc = lfs_crc(crc, wear_buf, n * sizeof(wear_buf[0]));
+        ret = wear_prog(device, base + WEAR_HDR_SIZE + b * sizeof(wear_buf[0]), wear_buf,
+                        n * sizeof(wear_buf[0]));
+    }
+    
+    if (ret == 0) {
+        struct wear_hdr hdr = {.magic = WEAR_MAGIC, .seq = w->seq + 1, .blocks = w->blocks, .crc = crc};
+        ret = wear_prog(device, base, &hdr, sizeof(hdr));
+    }
+    
+    /* Committed: drop what the new copy holds from the pending counts. If
+     * this fails part way the counts stay pending and are stored twice. */
+    for (lfs_block_t b = 0; ret == 0 && b < w->blocks; b += WEAR_CHUNK) {
+        size_t n = MIN(WEAR_CHUNK, w->blocks - b);
+        if (wear_read_chunk(device, w->cur, b, n, wear_old_buf) != 0 ||
+            wear_read_chunk(device, next, b, n, wear_buf) != 0) {
+            LOG_WRN("FLASH%d: Wear counts kept pending after write-back", device + 1);
+            break;
+        }
+        wear_take_pending(w, b, n, wear_old_buf, wear_buf);
+    }
+    if (ret == 0) {
+        w->cur = next;
+        w->seq++;
+    } else {
+        LOG_ERR("FLASH%d: Wear table write-back failed (%d)", device + 1, ret);
+    }
+    
+    /* The copy's own erase goes to the next write-back. Noted before the
+     * pending counts are taken, a full batch would queue another one. */
+    if (erased) wear_note_erase(device, base / FLASH_SECTOR_SIZE, copy_blocks);
+    k_mutex_unlock(&wear_flush_lock);
+    return ret;
+}
+
+static void wear_flush_work_handler(struct k_work *work)
+{
+    if (wear1.due) wear_flush(FLASH1);
+    if (wear2.due) wear_flush(FLASH2);
+}
+#endif
+
+/*============================================================================
+ * Raw Recording Log - FLASH2 segments outside LittleFS
+ *
+ * A ring of 64KB segments, each opened by a fixed header (magic, sequence
+ * number, first timestamp). Records follow back to back: a 12-byte header
+ * {time, len, ~len, payload CRC} programmed before the payload, padded to
+ * 4 bytes. A torn payload fails its CRC and is skipped by length; a torn
+ * header ends its segment. Nothing is rewritten on append, so recordings go
+ * to flash at page-program speed. rawlog_lock guards the state; the QSPI
+ * driver serializes FLASH2 access with LittleFS, so the log's erases never
+ * hold up filesystem calls.
+ *============================================================================*/
+
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+#define RAWLOG_MAGIC         0x52574C47  /* "RWLG" */
+#define RAWLOG_BASE          (RAWLOG_FIRST_BLOCK * FLASH_SECTOR_SIZE)
+#define RAWLOG_NONE          UINT32_MAX
+#define RAWLOG_REC_SIZE(len) (sizeof(struct rawlog_rec_hdr) + (((len) + 3) & ~3U))
+
+struct rawlog_seg_hdr {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t time;               /* Timestamp of the first record */
+    uint32_t crc;                /* Over the fields above */
+};
+
+struct rawlog_rec_hdr {
+    uint32_t time;
+    uint16_t len;
+    uint16_t len_inv;            /* ~len, tells a torn header from a real one */
+    uint32_t crc;                /* Over the payload */
+};
+
+static struct {
+    uint32_t head;               /* Segment being appended, RAWLOG_NONE if empty */
+    uint32_t head_off;           /* Next record offset in head */
+    uint32_t head_seq;
+    uint32_t used;               /* Segments holding data, the last one is head */
+    uint32_t next_ready;         /* Leading 4KB blocks of the next segment already erased */
+} rawlog = {.head = RAWLOG_NONE};
+
+static K_MUTEX_DEFINE(rawlog_lock);
+
+static uint8_t rawlog_scratch[256];
+
+static uint32_t rawlog_addr(uint32_t seg, uint32_t off)
+{
+    return RAWLOG_BASE + seg * RAWLOG_SEG_SIZE + off;
+}
+
+/* Segment i in age order, 0 = oldest */
+static uint32_t rawlog_seg_at(uint32_t i)
+{
+    return (rawlog.head + 1 + NOR_FLASH_RAWLOG_SEGMENTS - rawlog.used + i) % NOR_FLASH_RAWLOG_SEGMENTS;
+}
+
+/* Returns -ENODATA if the segment has no valid header (free) */
+static int rawlog_read_seg_hdr(uint32_t seg, struct rawlog_seg_hdr *hdr)
+{
+    int ret = flash_read(flash2_dev, rawlog_addr(seg, 0), hdr, sizeof(*hdr));
+    if (ret != 0) return ret;
+    if (hdr->magic != RAWLOG_MAGIC ||
+        hdr->crc != lfs_crc(0xFFFFFFFF, hdr, offsetof(struct rawlog_seg_hdr, crc))) {
+        return -ENODATA;
+    }
+    return 0;
+}
+
+/*
+ * Read the record header at off. Returns the record's size in the segment,
+ * 0 at the end of written data, or -EBADMSG if the header is torn (nothing
+ * after it in the segment can be trusted).
+ */
+static int rawlog_read_rec_hdr(uint32_t seg, uint32_t off, struct rawlog_rec_hdr *rec)
+{
+    if (off + sizeof(*rec) > RAWLOG_SEG_SIZE) return 0;
+    
+    int ret = flash_read(flash2_dev, rawlog_addr(seg, off), rec, sizeof(*rec));
+    if (ret != 0) return ret;
+    if (rec->time == UINT32_MAX && rec->len == 0xFFFF && rec->len_inv == 0xFFFF && rec->crc == UINT32_MAX) {
+        return 0;
+    }
+    if (rec->len_inv != (uint16_t)~rec->len || rec->len == 0 ||
+        off + RAWLOG_REC_SIZE(rec->len) > RAWLOG_SEG_SIZE) {
+        return -EBADMSG;
+    }
+    return RAWLOG_REC_SIZE(rec->len);
+}
+
+static int rawlog_check_payload(uint32_t seg, uint32_t off, const struct rawlog_rec_hdr *rec)
+{
+    uint32_t addr = rawlog_addr(seg, off) + sizeof(*rec);
+    uint32_t crc = 0xFFFFFFFF;
+    
+    for (size_t done = 0; done < rec->len; ) {
+        size_t n = MIN(sizeof(rawlog_scratch), (size_t)rec->len - done);
+        int ret = flash_read(flash2_dev, addr + done, rawlog_scratch, n);
+        if (ret != 0) return ret;
+        crc = lfs_crc(crc, rawlog_scratch, n);
+        done += n;
+    }
+    return (crc == rec->crc) ? 0 : -EBADMSG;
+}
+
+/* Erase the rest of the segment after head (a 64KB erase if none of it is ready) */
+static int rawlog_erase_next(uint32_t next, uint32_t first_block)
+{
+    uint32_t addr = rawlog_addr(next, first_block * FLASH_SECTOR_SIZE);
+    size_t len = (RAWLOG_SEG_BLOCKS - first_block) * FLASH_SECTOR_SIZE;
+    
+    int ret = flash_erase(flash2_dev, addr, len);
+#if NOR_FLASH_WEAR_TRACK
+    if (ret == 0) wear_note_erase(FLASH2, addr / FLASH_SECTOR_SIZE, len / FLASH_SECTOR_SIZE);
+#endif
+    return ret;
+}
+
+/* Open the segment after head, reclaiming the oldest if the ring is full */
+static int rawlog_advance(uint32_t time)
+{
+    uint32_t next = (rawlog.head == RAWLOG_NONE) ? 0 : (rawlog.head + 1) % NOR_FLASH_RAWLOG_SEGMENTS;
+    bool full = (rawlog.used == NOR_FLASH_RAWLOG_SEGMENTS);
+    
+    if (full && !NOR_FLASH_RAWLOG_WRAP) return -ENOSPC;
+    if (rawlog.next_ready < RAWLOG_SEG_BLOCKS) {
+        int ret = rawlog_erase_next(next, rawlog.next_ready);
+        if (ret != 0) return ret;
+    }
+    rawlog.next_ready = 0;
+    if (full) rawlog.used--;
+    
+    struct rawlog_seg_hdr hdr = {.magic = RAWLOG_MAGIC, .seq = rawlog.head_seq + 1, .time = time};
+    hdr.crc = lfs_crc(0xFFFFFFFF, &hdr, offsetof(struct rawlog_seg_hdr, crc));
+    int ret = flash_write(flash2_dev, rawlog_addr(next, 0), &hdr, sizeof(hdr));
+    if (ret != 0) return ret;
+    
+    rawlog.head = next;
+    rawlog.head_seq = hdr.seq;
+    rawlog.head_off = sizeof(hdr);
+    rawlog.used++;
+    return 0;
+}
+
+#if NOR_FLASH_PREERASE_POOL > 0
+/* Erase one 4KB block of the next segment so appends don't stall on it */
+static bool rawlog_preerase_step(void)
+{
+    bool erased = false;
+    
+    if (!flash2_initialized) return false;
+    k_mutex_lock(&rawlog_lock, K_FOREVER);
+    if (rawlog.used < NOR_FLASH_RAWLOG_SEGMENTS && rawlog.next_ready < RAWLOG_SEG_BLOCKS) {
+        uint32_t next = (rawlog.head == RAWLOG_NONE) ? 0 : (rawlog.head + 1) % NOR_FLASH_RAWLOG_SEGMENTS;
+        uint32_t addr = rawlog_addr(next, rawlog.next_ready * FLASH_SECTOR_SIZE);
+        erased = (flash_erase(flash2_dev, addr, FLASH_SECTOR_SIZE) == 0);
+        if (erased) {
+            rawlog.next_ready++;
+#if NOR_FLASH_WEAR_TRACK
+            wear_note_erase(FLASH2, addr / FLASH_SECTOR_SIZE, 1);
+#endif
+        }
+    }
+    k_mutex_unlock(&rawlog_lock);
+    return erased;
+}
+#endif
+#endif
+
+/*============================================================================
+ * LittleFS Callbacks - Flash1 (SPI)
+ *============================================================================*/
+
+static int lfs1_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buf, lfs_size_t size)
+{
+    uint32_t addr = (block * FLASH_SECTOR_SIZE) + off;
+    stats_time_t start = stats_start();
+    int ret = flash1_read_data(addr, buf, size) == 0 ? LFS_ERR_OK : LFS_ERR_IO;
+    stats_record(&lfs1_stats, NOR_FLASH_OP_READ, size, start, ret);
+    return ret;
+}
+
+static int lfs1_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buf, lfs_size_t size)
+{
+    uint32_t addr = (block * FLASH_SECTOR_SIZE) + off;
+    if (lfs1_readonly) return LFS_ERR_IO;
+#if NOR_FLASH_PREERASE_POOL > 0
+    preerase_claim_check(FLASH1, block, false);
+    erased_map_set(lfs1_erased_map, block, false);
+#endif
+    stats_time_t start = stats_start();
+    int ret = flash1_prog_data(addr, buf, size) == 0 ? LFS_ERR_OK : LFS_ERR_IO;
+    stats_record(&lfs1_stats, NOR_FLASH_OP_PROG, size, start, ret);
+    return ret;
+}
+
+static int lfs1_erase(const struct lfs_config *c, lfs_block_t block)
+{
+    uint32_t addr = block * FLASH_SECTOR_SIZE;
+    if (lfs1_readonly) return LFS_ERR_IO;
+#if NOR_FLASH_PREERASE_POOL > 0
+    preerase_claim_check(FLASH1, block, true);
+    if (erased_map_test(lfs1_erased_map, block)) {  /* Pre-erased */
+        lfs1_stats.erases_skipped++;
+        return LFS_ERR_OK;
+    }
+#endif
+    stats_time_t start = stats_start();
+    int ret = flash1_erase_sector(addr) == 0 ? LFS_ERR_OK : LFS_ERR_IO;
+    stats_record(&lfs1_stats, NOR_FLASH_OP_ERASE, FLASH_SECTOR_SIZE, start, ret);
+#if NOR_FLASH_WEAR_TRACK
+    if (ret == LFS_ERR_OK) wear_note_erase(FLASH1, block, 1);
+#endif
+#if NOR_FLASH_PREERASE_POOL > 0
+    if (ret == LFS_ERR_OK) erased_map_set(lfs1_erased_map, block, true);
+#endif
+    return ret;
+}
+
+static int lfs1_sync(const struct lfs_config *c)
+{
+    stats_record(&lfs1_stats, NOR_FLASH_OP_SYNC, 0, stats_start(), LFS_ERR_OK);
+    return LFS_ERR_OK;
+}
+
+/*============================================================================
+ * LittleFS Callbacks - Flash2 (QSPI via Zephyr API)
+ *============================================================================*/
+
+static int lfs2_read(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, void *buf, lfs_size_t size)
+{
+    uint32_t addr = (block * FLASH_SECTOR_SIZE) + off;
+    stats_time_t start = stats_start();
+    int ret = flash_read(flash2_dev, addr, buf, size);
+    ret = (ret == 0) ? LFS_ERR_OK : LFS_ERR_IO;
+    stats_record(&lfs2_stats, NOR_FLASH_OP_READ, size, start, ret);
+    return ret;
+}
+
+static int lfs2_prog(const struct lfs_config *c, lfs_block_t block, lfs_off_t off, const void *buf, lfs_size_t size)
+{
+    uint32_t addr = (block * FLASH_SECTOR_SIZE) + off;
+    if (lfs2_readonly) return LFS_ERR_IO;
+#if NOR_FLASH_PREERASE_POOL > 0
+    preerase_claim_check(FLASH2, block, false);
+    erased_map_set(lfs2_erased_map, block, false);
+#endif
+    stats_time_t start = stats_start();
+    int ret = flash_write(flash2_dev, addr, buf, size);
+    ret = (ret == 0) ? LFS_ERR_OK : LFS_ERR_IO;
+    stats_record(&lfs2_stats, NOR_FLASH_OP_PROG, size, start, ret);
+    return ret;
+}
+
+static int lfs2_erase(const struct lfs_config *c, lfs_block_t block)
+{
+    uint32_t addr = block * FLASH_SECTOR_SIZE;
+    if (lfs2_readonly) return LFS_ERR_IO;
+#if NOR_FLASH_PREERASE_POOL > 0
+    preerase_claim_check(FLASH2, block, true);
+    if (erased_map_test(lfs2_erased_map, block)) {  /* Pre-erased */
+        lfs2_stats.erases_skipped++;
+        return LFS_ERR_OK;
+    }
+#endif
+    stats_time_t start = stats_start();
+    int ret = flash_erase(flash2_dev, addr, FLASH_SECTOR_SIZE);
+    ret = (ret == 0) ? LFS_ERR_OK : LFS_ERR_IO;
+    stats_record(&lfs2_stats, NOR_FLASH_OP_ERASE, FLASH_SECTOR_SIZE, start, ret);
+#if NOR_FLASH_WEAR_TRACK
+    if (ret == LFS_ERR_OK) wear_note_erase(FLASH2, block, 1);
+#endif
+#if NOR_FLASH_PREERASE_POOL > 0
+    if (ret == LFS_ERR_OK) erased_map_set(lfs2_erased_map, block, true);
+#endif
+    return ret;
+}
+
+static int lfs2_sync(const struct lfs_config *c)
+{
+    stats_record(&lfs2_stats, NOR_FLASH_OP_SYNC, 0, stats_start(), LFS_ERR_OK);
+    return LFS_ERR_OK;
+}
+
+/*============================================================================
+ * LittleFS Locking - context points at the device's filesystem mutex
+ *============================================================================*/
+
+static int lfs_lock_cb(const struct lfs_config *c)
+{
+    return k_mutex_lock((struct k_mutex *)c->context, K_FOREVER) == 0 ? LFS_ERR_OK : LFS_ERR_IO;
+}
+
+static int lfs_unlock_cb(const struct lfs_config *c)
+{
+    return k_mutex_unlock((struct k_mutex *)c->context) == 0 ? LFS_ERR_OK : LFS_ERR_IO;
+}
+
+/*============================================================================
+ * LittleFS Mount
+ *============================================================================*/
+
+/*============================================================================
+ * Mount Snapshot - allocator state kept in retained RAM across System OFF
+ *
+ * The first allocation after lfs_mount() traverses every file to rebuild the
+ * lookahead bitmap. When the lookahead covers the whole device the bitmap
+ * and cursor can be saved before sleep and put back after the next mount.
+ * lfs->seed after a fresh mount is a CRC of every metadata commit on flash,
+ * so a matching seed proves nothing changed in between.
+ *============================================================================*/
+
+#if NOR_FLASH_MOUNT_SNAPSHOT
+#define SNAPSHOT_MAGIC  0x4C465353  /* "LFSS" */
+
+struct lfs_snapshot {
+    uint32_t magic;
+    uint32_t generation;        /* Bumped on every save */
+    uint32_t seed;              /* lfs->seed of the mount that produced it */
+    lfs_block_t block_count;
+    lfs_block_t off, size, i;   /* lfs->free cursor */
+    uint32_t crc;               /* Over the fields above and the bitmap */
+};
+
+static __noinit struct lfs_snapshot lfs1_snap, lfs2_snap;
+static __noinit uint32_t lfs1_snap_map[FLASH1_LFS_LOOKAHEAD_SIZE / 4];
+static __noinit uint32_t lfs2_snap_map[FLASH2_LFS_LOOKAHEAD_SIZE / 4];
+static uint32_t lfs1_snap_gen, lfs2_snap_gen;
+
+/* Generation written by the last save, with its complement, kept apart from
+ * the snapshot so a stale but intact one left from an earlier save is refused */
+static __noinit uint32_t lfs_snap_expect[2][2];
+
+static uint32_t snapshot_crc(const struct lfs_snapshot *snap, const uint32_t *map, size_t map_len)
+{
+    uint32_t crc = lfs_crc(0xFFFFFFFF, snap, offsetof(struct lfs_snapshot, crc));
+    return lfs_crc(crc, map, map_len);
+}
+
+/* Put a matching snapshot back into a freshly mounted lfs; call with fs lock held */
+static bool snapshot_restore(flash_device_t device)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    struct lfs_snapshot *snap = (device == FLASH1) ? &lfs1_snap : &lfs2_snap;
+    uint32_t *map = (device == FLASH1) ? lfs1_snap_map : lfs2_snap_map;
+    size_t map_len = (device == FLASH1) ? sizeof(lfs1_snap_map) : sizeof(lfs2_snap_map);
+    bool ok = snap->magic == SNAPSHOT_MAGIC &&
+              snap->crc == snapshot_crc(snap, map, map_len) &&
+              snap->generation == lfs_snap_expect[device][0] &&
+              ~snap->generation == lfs_snap_expect[device][1] &&
+              snap->block_count == lfs->cfg->block_count &&
+              snap->seed == lfs->seed &&
+              snap->size <= 8 * lfs->cfg->lookahead_size && snap->i <= snap->size;
+    
+    if (ok) {
+        memcpy(lfs->free.buffer, map, map_len);
+        lfs->free.off = snap->off;
+        lfs->free.size = snap->size;
+        lfs->free.i = snap->i;
+        lfs->free.ack = lfs->cfg->block_count;
+        *((device == FLASH1) ? &lfs1_snap_gen : &lfs2_snap_gen) = snap->generation;
+        LOG_INF("FLASH%d: Allocator snapshot gen %u restored", device + 1, snap->generation);
+    }
+    
+    /* One-shot: the live state diverges as soon as anything is written */
+    snap->magic = 0;
+    return ok;
+}
+#endif
+
+/*============================================================================
+ * Mount Recovery - retry, repair, read-only fallback; never formats
+ *============================================================================*/
+
+/*
+ * Bring a flash back to a known state between mount attempts. FLASH1 gets a
+ * software reset (66h/99h), ID check and read mode re-selection. FLASH2's QSPI
+ * peripheral is power-cycled when device PM is enabled, then re-probed.
+ */
+static int flash_recover_bus(flash_device_t device)
+{
+    if (device == FLASH1) {
+        uint8_t cmd[1] = {CMD_RESET_ENABLE};
+        flash1_transceive(cmd, 1, NULL, 0);
+        cmd[0] = CMD_RESET;
+        flash1_transceive(cmd, 1, NULL, 0);
+        k_msleep(FLASH1_TREADY2_MS);
+        
+        uint8_t id[3];
+        if (flash1_read_id(id) != 0 || id[0] != 0xC2) return -EIO;
+        flash1_select_read_mode();
+        return 0;
+    }
+    
+#ifdef CONFIG_PM_DEVICE
+    pm_device_action_run(flash2_dev, PM_DEVICE_ACTION_SUSPEND);
+    pm_device_action_run(flash2_dev, PM_DEVICE_ACTION_RESUME);
+#endif
+    uint8_t probe[4];
+    return flash_read(flash2_dev, 0, probe, sizeof(probe));
+}
+
+#if NOR_FLASH_FORMAT_BLANK
+/*
+ * The part answers with its identity: RDID manufacturer and an SFDP header.
+ * Checked right before a blank chip is formatted, since no chip on the bus
+ * reads all 0xFF as well.
+ */
+static int flash_identify(flash_device_t device)
+{
+    uint8_t id[3], sfdp[8];
+    int ret;
+    
+    if (device == FLASH1) {
+        ret = flash1_read_id(id);
+        if (ret == 0) ret = flash1_read_sfdp(0, sfdp, sizeof(sfdp));
+    } else {
+#if defined(CONFIG_FLASH_JESD216_API)
+        ret = flash_read_jedec_id(flash2_dev, id);
+        if (ret == 0) ret = flash_sfdp_read(flash2_dev, 0, sfdp, sizeof(sfdp));
+#else
+        ret = -ENOTSUP;
+#endif
+    }
+    if (ret != 0) return ret;
+    if (id[0] != 0xC2 || sys_get_le32(sfdp) != SFDP_SIGNATURE) return -ENODEV;
+    return 0;
+}
+
+/* True if the whole LittleFS range reads erased; stops at the first written byte */
+static bool lfs_range_blank(const struct lfs_config *cfg)
+{
+    uint32_t *buf = cfg->read_buffer;   /* Unused until the next mount */
+    
+    for (lfs_block_t block = 0; block < cfg->block_count; block++) {
+        for (lfs_off_t off = 0; off < cfg->block_size; off += cfg->cache_size) {
+            if (cfg->read(cfg, block, off, buf, cfg->cache_size) != LFS_ERR_OK) return false;
+            for (size_t i = 0; i < cfg->cache_size / 4; i++) {
+                if (buf[i] != 0xFFFFFFFF) return false;
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+/*
+ * Stage 1: mount, retried up to NOR_FLASH_MOUNT_RETRIES times after a bus
+ * reset, and restore the allocator snapshot. Nothing is written. A device
+ * that still fails, or whose bus reset fails, stays unmounted. Call with the
+ * fs lock held.
+ */
+static int lfs_init_mount(flash_device_t device)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    struct lfs_config *cfg = (device == FLASH1) ? &lfs_cfg1 : &lfs_cfg2;
+    const char *name = (device == FLASH1) ? "FLASH1" : "FLASH2";
+    uint32_t start = k_uptime_get_32();
+    
+    int ret = lfs_mount(lfs, cfg);
+    for (int attempt = 1; ret != LFS_ERR_OK && attempt <= NOR_FLASH_MOUNT_RETRIES; attempt++) {
+        LOG_WRN("%s: Mount failed (%d), bus reset and retry %d/%d", name, ret,
+                attempt, NOR_FLASH_MOUNT_RETRIES);
+        int err = flash_recover_bus(device);
+        if (err != 0) {
+            LOG_ERR("%s: Bus reset failed (%d) after %u ms", name, err, k_uptime_get_32() - start);
+            return -EIO;
+        }
+        ret = lfs_mount(lfs, cfg);
+    }
+    
+    if (ret != LFS_ERR_OK) {
+        LOG_ERR("%s: Not mountable (%d) after %u ms", name, ret, k_uptime_get_32() - start);
         return -EIO;
     }
     
-    LOG_INF("%s: LittleFS formatted and mounted", name);
-    return 0;
+#if NOR_FLASH_MOUNT_SNAPSHOT
+    bool fast = snapshot_restore(device);
+#else
+    bool fast = false;
+#endif
+    
+    LOG_INF("%s: LittleFS mounted in %u ms%s", name, k_uptime_get_32() - start,
+            fast ? " (snapshot)" : "");
+    return 0;
+}
+
+/*
+ * Stage 2, the first writes: finish interrupted moves and drop orphans now
+ * instead of on the first write. If that fails the device stays mounted
+ * read-only so recorded data can still be pulled off. A device that did not
+ * mount is left as is, unless NOR_FLASH_FORMAT_BLANK is set, its LittleFS
+ * range reads fully erased and a bus reset and ID check then pass (a new
+ * chip), which is formatted. Call with the fs lock held.
+ */
+static int lfs_init_repair(flash_device_t device)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    bool *mounted = (device == FLASH1) ? &lfs1_mounted : &lfs2_mounted;
+    bool *readonly = (device == FLASH1) ? &lfs1_readonly : &lfs2_readonly;
+    const char *name = (device == FLASH1) ? "FLASH1" : "FLASH2";
+    uint32_t start = k_uptime_get_32();
+    int ret;
+    
+    if (!*mounted) {
+#if NOR_FLASH_FORMAT_BLANK
+        struct lfs_config *cfg = (device == FLASH1) ? &lfs_cfg1 : &lfs_cfg2;
+        if (lfs_range_blank(cfg)) {
+            ret = flash_recover_bus(device);
+            if (ret == 0) ret = flash_identify(device);
+            if (ret != 0) {
+                LOG_ERR("%s: Reads blank but bus reset/ID check failed (%d), not formatting",
+                        name, ret);
+                return -EIO;
+            }
+            LOG_INF("%s: Blank chip, formatting", name);
+#if NOR_FLASH_PREERASE_POOL > 0
+            memset((device == FLASH1) ? lfs1_erased_map : lfs2_erased_map, 0xFF,
+                   (device == FLASH1) ? sizeof(lfs1_erased_map) : sizeof(lfs2_erased_map));
+#endif
+            ret = lfs_format(lfs, cfg);
+            if (ret == LFS_ERR_OK) ret = lfs_mount(lfs, cfg);
+            if (ret != LFS_ERR_OK) {
+                LOG_ERR("%s: Format of blank chip failed (%d)", name, ret);
+                return -EIO;
+            }
+            *mounted = true;
+            *readonly = false;
+            LOG_INF("%s: Formatted in %u ms", name, k_uptime_get_32() - start);
+            return 0;
+        }
+#endif
+        LOG_ERR("%s: Left as is - use nor_flash_format()", name);
+        return -EIO;
+    }
+    
+    *readonly = false;
+    ret = lfs_fs_mkconsistent(lfs);
+    if (ret != LFS_ERR_OK) {
+        *readonly = true;
+        LOG_ERR("%s: Repair failed (%d), mounted read-only", name, ret);
+    }
+    
+    LOG_INF("%s: Repair in %u ms", name, k_uptime_get_32() - start);
+    return 0;
+}
+
+/*============================================================================
+ * Asynchronous Programming - worker thread fed by a request queue
+ *============================================================================*/
+
+struct prog_async_req {
+    flash_device_t device;
+    uint32_t addr;
+    const void *data;
+    size_t len;
+    nor_flash_prog_cb_t cb;
+    void *user_data;
+    struct k_poll_signal *signal;
+};
+
+K_MSGQ_DEFINE(prog_async_queue, sizeof(struct prog_async_req), NOR_FLASH_PROG_QUEUE_DEPTH, 4);
+
+static void prog_async_thread(void *p1, void *p2, void *p3)
+{
+    struct prog_async_req req;
+    
+    while (true) {
+        k_msgq_get(&prog_async_queue, &req, K_FOREVER);
+        
+        int ret = 0;
+        if (req.len > 0) {
+#if NOR_FLASH_PREERASE_POOL > 0
+            /* The blocks are no longer blank for a later format or mount */
+            struct k_mutex *lock = (req.device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+            uint32_t *map = (req.device == FLASH1) ? lfs1_erased_map : lfs2_erased_map;
+            k_mutex_lock(lock, K_FOREVER);
+            for (uint32_t b = req.addr / FLASH_SECTOR_SIZE; b <= (req.addr + req.len - 1) / FLASH_SECTOR_SIZE; b++) {
+                erased_map_set(map, b, false);
+            }
+            k_mutex_unlock(lock);
+#endif
+            if (req.device == FLASH1) {
+                ret = flash1_prog_data(req.addr, req.data, req.len);
+            } else {
+                ret = flash_write(flash2_dev, req.addr, req.data, req.len);
+            }
+            if (ret != 0) {
+                LOG_ERR("FLASH%d: Async program at 0x%08X failed (%d)", req.device + 1, req.addr, ret);
+            }
+        }
+        
+        if (req.cb) {
+            req.cb(req.device, ret, req.user_data);
+        }
+        if (req.signal) {
+            k_poll_signal_raise(req.signal, ret);
+        }
+    }
+}
+
+K_THREAD_DEFINE(prog_async_tid, NOR_FLASH_PROG_STACK_SIZE, prog_async_thread,
+                NULL, NULL, NULL, NOR_FLASH_PROG_PRIORITY, 0, 0);
+
+/*============================================================================
+ * Background Pre-erase - keeps the next free blocks LittleFS will allocate
+ * in the erased state, so lfsN_erase() can skip them in the write path
+ *============================================================================*/
+
+#if NOR_FLASH_PREERASE_POOL > 0
+/*
+ * Walk the current lookahead window from the allocator's cursor (free.i) in
+ * allocation order. Blocks with a clear bit in free.buffer are free; count the
+ * ones already erased and claim the first one that isn't. The block is picked
+ * under the filesystem lock but erased without it, so LittleFS calls (and on
+ * FLASH1 the reads that suspend the erase) are not held up for the erase
+ * time. It is only marked erased if LittleFS did not touch it meanwhile and
+ * it is still free ahead of the cursor in the same window.
+ * Returns true if a block was erased.
+ */
+static bool preerase_step(flash_device_t device)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    struct k_mutex *lock = (device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+    uint32_t *map = (device == FLASH1) ? lfs1_erased_map : lfs2_erased_map;
+    bool *mounted = (device == FLASH1) ? &lfs1_mounted : &lfs2_mounted;
+    bool *readonly = (device == FLASH1) ? &lfs1_readonly : &lfs2_readonly;
+    struct preerase_claim *c = &preerase_claim[device];
+    lfs_block_t i, off = 0, block = PREERASE_NONE;
+    size_t ready = 0;
+    
+    k_mutex_lock(lock, K_FOREVER);
+    for (i = lfs->free.i; *mounted && !*readonly && i < lfs->free.size && ready < NOR_FLASH_PREERASE_POOL; i++) {
+        if (lfs->free.buffer[i / 32] & (1U << (i % 32))) continue;  /* In use */
+        
+        lfs_block_t b = (lfs->free.off + i) % lfs->cfg->block_count;
+        if (erased_map_test(map, b)) {
+            ready++;
+            continue;
+        }
+        block = b;
+        break;
+    }
+    if (block != PREERASE_NONE) {
+        off = lfs->free.off;
+        c->block = block;
+        c->taken = false;
+        k_sem_reset(c->done);
+        atomic_set(&c->erasing, 1);
+    }
+    k_mutex_unlock(lock);
+    if (block == PREERASE_NONE) return false;
+    
+    uint32_t addr = block * FLASH_SECTOR_SIZE;
+    int ret = (device == FLASH1) ? flash1_erase_sector(addr) : flash_erase(flash2_dev, addr, FLASH_SECTOR_SIZE);
+    atomic_set(&c->erasing, 0);
+    k_sem_give(c->done);
+#if NOR_FLASH_WEAR_TRACK
+    if (ret == 0) wear_note_erase(device, block, 1);
+#endif
+    
+    k_mutex_lock(lock, K_FOREVER);
+    if (ret == 0 && !c->taken && *mounted && lfs->free.off == off &&
+        i >= lfs->free.i && i < lfs->free.size && !(lfs->free.buffer[i / 32] & (1U << (i % 32)))) {
+        erased_map_set(map, block, true);
+    }
+    c->block = PREERASE_NONE;
+    k_mutex_unlock(lock);
+    return ret == 0;
+}
+
+static void preerase_thread(void *p1, void *p2, void *p3)
+{
+    while (true) {
+        bool busy = preerase_step(FLASH1);
+        busy |= preerase_step(FLASH2);
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+        busy |= rawlog_preerase_step();
+#endif
+        if (!busy) {
+            k_msleep(NOR_FLASH_PREERASE_INTERVAL_MS);
+        }
+    }
+}
+
+/* Lowest application priority: only runs when every other thread is idle.
+ * Started by nor_flash_system_start(), the point from which writes are allowed. */
+K_THREAD_DEFINE(preerase_tid, NOR_FLASH_PREERASE_STACK_SIZE, preerase_thread,
+                NULL, NULL, NULL, K_LOWEST_APPLICATION_THREAD_PRIO, 0, SYS_FOREVER_MS);
+#endif
+
+/*============================================================================
+ * Public API
+ *============================================================================*/
+
+/*============================================================================
+ * Parallel Bring-up - SPI1 and QSPI are independent buses
+ *============================================================================*/
+
+static int flash1_init_status = -EAGAIN, flash2_init_status = -EAGAIN;
+static K_THREAD_STACK_DEFINE(flash2_init_stack, NOR_FLASH_INIT_STACK_SIZE);
+static struct k_thread flash2_init_thread;
+
+/* Driver init, then the write-free mount stage under the device's fs lock */
+static int device_bringup(flash_device_t device)
+{
+    struct k_mutex *lock = (device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+    bool *mounted = (device == FLASH1) ? &lfs1_mounted : &lfs2_mounted;
+    uint32_t start = k_uptime_get_32();
+    
+    int ret = (device == FLASH1) ? flash1_init() : flash2_init();
+    if (ret != 0) {
+        LOG_ERR("FLASH%d init failed (%d)", device + 1, ret);
+        return ret;
+    }
+#if NOR_FLASH_WEAR_TRACK
+    wear_load(device);
+#endif
+    
+    k_mutex_lock(lock, K_FOREVER);
+    ret = lfs_init_mount(device);
+    *mounted = (ret == 0);
+    k_mutex_unlock(lock);
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+    if (device == FLASH2) nor_flash_rawlog_recover();
+#endif
+    
+    LOG_INF("FLASH%d: Up in %u ms", device + 1, k_uptime_get_32() - start);
+    return ret;
+}
+
+static void flash2_bringup_thread(void *p1, void *p2, void *p3)
+{
+    flash2_init_status = device_bringup(FLASH2);
+}
+
+int nor_flash_system_mount(void)
+{
+    LOG_INF("Initializing dual NOR flash system...");
+#if NOR_FLASH_STATS && defined(CONFIG_TIMING_FUNCTIONS)
+    timing_init();
+    timing_start();
+#endif
+    LOG_INF("FLASH1 (SPI): %s (%d MB)", FLASH1_CHIP_NAME, FLASH1_SIZE_MB);
+    LOG_INF("FLASH2 (QSPI): %s (%d MB)", FLASH2_CHIP_NAME, FLASH2_SIZE_MB);
+    LOG_INF("LFS geometry: read %d/%d, prog %d/%d, cache %d/%d, lookahead %d/%d blocks",
+            FLASH1_LFS_READ_SIZE, FLASH2_LFS_READ_SIZE, FLASH1_LFS_PROG_SIZE, FLASH2_LFS_PROG_SIZE,
+            FLASH1_LFS_CACHE_SIZE, FLASH2_LFS_CACHE_SIZE,
+            (int)(FLASH1_LFS_LOOKAHEAD_SIZE * 8), (int)(FLASH2_LFS_LOOKAHEAD_SIZE * 8));
+    
+    /* Setup LittleFS buffers */
+    lfs_cfg1.read_buffer = lfs1_read_buf;
+    lfs_cfg1.prog_buffer = lfs1_prog_buf;
+    lfs_cfg1.lookahead_buffer = lfs1_look_buf;
+    
+    lfs_cfg2.read_buffer = lfs2_read_buf;
+    lfs_cfg2.prog_buffer = lfs2_prog_buf;
+    lfs_cfg2.lookahead_buffer = lfs2_look_buf;
+    
+    /* FLASH2 (QSPI) comes up on a worker while FLASH1 (SPI) runs here, so
+     * startup costs the slower of the two; a failure of one never blocks
+     * the other */
+    uint32_t start = k_uptime_get_32();
+    k_thread_create(&flash2_init_thread, flash2_init_stack, K_THREAD_STACK_SIZEOF(flash2_init_stack),
+                    flash2_bringup_thread, NULL, NULL, NULL,
+                    k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+    flash1_init_status = device_bringup(FLASH1);
+    k_thread_join(&flash2_init_thread, K_FOREVER);
+    
+    LOG_INF("Flash bring-up in %u ms (FLASH1 %d, FLASH2 %d)", k_uptime_get_32() - start,
+            flash1_init_status, flash2_init_status);
+    return (flash1_init_status != 0 || flash2_init_status != 0) ? -EIO : 0;
+}
+
+int nor_flash_system_start(void)
+{
+    static bool started;
+    
+    if (started) return -EALREADY;
+    started = true;
+    
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        struct k_mutex *lock = (device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+        int *status = (device == FLASH1) ? &flash1_init_status : &flash2_init_status;
+        bool ready = (device == FLASH1) ? flash1.initialized : flash2_initialized;
+        
+        if (!ready) continue;
+        k_mutex_lock(lock, K_FOREVER);
+        *status = lfs_init_repair(device);
+        k_mutex_unlock(lock);
+    }
+#if NOR_FLASH_PREERASE_POOL > 0
+    k_thread_start(preerase_tid);
+#endif
+#if NOR_FLASH_WEAR_TRACK
+    k_work_queue_init(&wear_work_q);
+    k_work_queue_start(&wear_work_q, wear_work_stack, K_THREAD_STACK_SIZEOF(wear_work_stack),
+                       K_LOWEST_APPLICATION_THREAD_PRIO, NULL);
+    if (wear1.due || wear2.due) k_work_submit_to_queue(&wear_work_q, &wear_flush_work);
+#endif
+    if (flash1_init_status != 0 || flash2_init_status != 0) return -EIO;
+    
+    LOG_INF("Dual flash system ready - Total: %d MB", FLASH1_SIZE_MB + FLASH2_SIZE_MB);
+    return 0;
+}
+
+int nor_flash_system_init(void)
+{
+    nor_flash_system_mount();
+    return nor_flash_system_start();
+}
+
+/* A device that failed bring-up has no lfs state (lfs->cfg is NULL) */
+static bool lfs_is_mounted(flash_device_t device)
+{
+    return (device == FLASH1) ? lfs1_mounted : lfs2_mounted;
+}
+
+int nor_flash_write_file(flash_device_t device, const char *filename, const void *data, size_t len)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    lfs_file_t file;
+    
+    if (!lfs_is_mounted(device)) return -ENODEV;
+    
+    int ret = lfs_file_open(lfs, &file, filename, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
+    if (ret < 0) return ret;
+    
+    ret = lfs_file_write(lfs, &file, data, len);
+    lfs_file_close(lfs, &file);
+    
+    if (ret >= 0) {
+        LOG_INF("FLASH%d: Wrote %s (%zu bytes)", device + 1, filename, len);
+    }
+    return (ret >= 0) ? 0 : ret;
+}
+
+int nor_flash_read_file(flash_device_t device, const char *filename, void *buffer, size_t len)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    lfs_file_t file;
+    
+    if (!lfs_is_mounted(device)) return -ENODEV;
+    
+    int ret = lfs_file_open(lfs, &file, filename, LFS_O_RDONLY);
+    if (ret < 0) return ret;
+    
+    ret = lfs_file_read(lfs, &file, buffer, len);
+    lfs_file_close(lfs, &file);
+    
+    if (ret >= 0) {
+        LOG_INF("FLASH%d: Read %s (%d bytes)", device + 1, filename, ret);
+    }
+    return ret;
+}
+
+int nor_flash_write_struct(flash_device_t device, const char *filename, const void *data, size_t size)
+{
+    return nor_flash_write_file(device, filename, data, size);
+}
+
+int nor_flash_read_struct(flash_device_t device, const char *filename, void *buffer, size_t size)
+{
+    int ret = nor_flash_read_file(device, filename, buffer, size);
+    if (ret < 0) return ret;
+    if ((size_t)ret != size) {
+        LOG_ERR("Size mismatch: expected %zu, got %d", size, ret);
+        return -EIO;
+    }
+    return 0;
+}
+
+int nor_flash_get_stats(flash_device_t device, struct nor_flash_stats *stats)
+{
+#if NOR_FLASH_STATS
+    struct k_mutex *lock = (device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+    
+    if (stats == NULL) return -EINVAL;
+    k_mutex_lock(lock, K_FOREVER);
+    *stats = (device == FLASH1) ? lfs1_stats : lfs2_stats;
+    k_mutex_unlock(lock);
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+void nor_flash_reset_stats(flash_device_t device)
+{
+    struct k_mutex *lock = (device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+    
+    k_mutex_lock(lock, K_FOREVER);
+    memset((device == FLASH1) ? &lfs1_stats : &lfs2_stats, 0, sizeof(struct nor_flash_stats));
+    k_mutex_unlock(lock);
+}
+
+uint32_t nor_flash_stats_percentile(const struct nor_flash_op_stats *op, unsigned int pct)
+{
+    uint32_t target = DIV_ROUND_UP((uint64_t)op->count * MIN(pct, 100U), 100U);
+    uint32_t seen = 0;
+    
+    if (op->count == 0) return 0;
+    for (int b = 0; b < NOR_FLASH_STATS_BUCKETS - 1; b++) {
+        seen += op->hist[b];
+        if (seen >= target) return MIN(BIT(b), op->max_us);
+    }
+    return op->max_us;
+}
+
+void nor_flash_dump_stats(flash_device_t device)
+{
+    static const char *const names[NOR_FLASH_OP_COUNT] = {"read", "prog", "erase", "sync"};
+    struct nor_flash_stats st;
+    
+    if (nor_flash_get_stats(device, &st) != 0) return;
+    for (int i = 0; i < NOR_FLASH_OP_COUNT; i++) {
+        const struct nor_flash_op_stats *op = &st.op[i];
+        LOG_INF("FLASH%d %-5s n=%u err=%u %u KB, us min/avg/max/p99 %u/%u/%u/%u", device + 1,
+                names[i], op->count, op->errors, (uint32_t)(op->bytes / 1024), op->min_us,
+                op->count ? (uint32_t)(op->total_us / op->count) : 0, op->max_us,
+                nor_flash_stats_percentile(op, 99));
+    }
+    LOG_INF("FLASH%d compactions=%u relocations=%u pre-erased hits=%u", device + 1,
+            st.compactions, st.relocations, st.erases_skipped);
+    
+    struct nor_flash_wear wear;
+    if (nor_flash_get_wear(device, &wear) == 0) {
+        LOG_INF("FLASH%d wear: erases min/avg/max %u/%u/%u over %u blocks", device + 1, wear.min,
+                (uint32_t)(wear.total / wear.blocks), wear.max, wear.blocks);
+    }
+}
+
+int nor_flash_get_wear(flash_device_t device, struct nor_flash_wear *wear)
+{
+#if NOR_FLASH_WEAR_TRACK
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+    bool ready = (device == FLASH1) ? flash1.initialized : flash2_initialized;
+    int ret = 0;
+    
+    if (wear == NULL) return -EINVAL;
+    if (!ready) return -ENODEV;
+    
+    memset(wear, 0, sizeof(*wear));
+    wear->blocks = w->blocks;
+    wear->min = UINT32_MAX;
+    
+    /* Pass 0 finds the range, pass 1 fills buckets sized to it */
+    k_mutex_lock(&wear_flush_lock, K_FOREVER);
+    for (int pass = 0; pass < 2 && ret == 0; pass++) {
+        if (pass == 1) {
+            wear->bucket_width = MAX(DIV_ROUND_UP(wear->max + 1, NOR_FLASH_WEAR_BUCKETS), 1U);
+        }
+        for (lfs_block_t b = 0; b < w->blocks; b += WEAR_CHUNK) {
+            size_t n = MIN(WEAR_CHUNK, w->blocks - b);
+            ret = wear_read_chunk(device, w->cur, b, n, wear_buf);
+            if (ret != 0) break;
+            wear_merge_pending(w, b, n, wear_buf);
+            for (size_t i = 0; i < n; i++) {
+                uint32_t c = wear_buf[i];
+                if (pass == 0) {
+                    wear->min = MIN(wear->min, c);
+                    wear->max = MAX(wear->max, c);
+                    wear->total += c;
+                } else {
+                    wear->hist[MIN(c / wear->bucket_width, NOR_FLASH_WEAR_BUCKETS - 1)]++;
+                }
+            }
+        }
+    }
+    wear->lost = w->lost;
+    k_mutex_unlock(&wear_flush_lock);
+    return ret;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+int nor_flash_wear_flush(flash_device_t device)
+{
+#if NOR_FLASH_WEAR_TRACK
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+    bool ready = (device == FLASH1) ? flash1.initialized : flash2_initialized;
+    
+    if (!ready) return -ENODEV;
+    return (w->pending_total > 0) ? wear_flush(device) : 0;
+#else
+    return -ENOTSUP;
+#endif
 }
 
-/*============================================================================
- * Public API
- *============================================================================*/
+int nor_flash_init_status(flash_device_t device)
+{
+    return (device == FLASH1) ? flash1_init_status : flash2_init_status;
+}
 
-int nor_flash_system_init(void)
+int nor_flash_rawlog_recover(void)
 {
-    LOG_INF("Initializing dual NOR flash system...");
-    LOG_INF("FLASH1 (SPI): %s (%d MB)", FLASH1_CHIP_NAME, FLASH1_SIZE_MB);
-    LOG_INF("FLASH2 (QSPI): %s (%d MB)", FLASH2_CHIP_NAME, FLASH2_SIZE_MB);
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+    struct rawlog_seg_hdr hdr;
+    struct rawlog_rec_hdr rec;
+    uint32_t head = RAWLOG_NONE, head_seq = 0, used = 0, off = sizeof(hdr);
+    int ret = 0, damaged = 0;
     
-    /* Init Flash1 (SPI) */
-    if (flash1_init() != 0) {
-        LOG_ERR("FLASH1 init failed");
-        return -EIO;
+    if (!flash2_initialized) return -ENODEV;
+    
+    k_mutex_lock(&rawlog_lock, K_FOREVER);
+    /* Valid segments are contiguous in the ring and end at the highest seq */
+    for (uint32_t seg = 0; seg < NOR_FLASH_RAWLOG_SEGMENTS; seg++) {
+        ret = rawlog_read_seg_hdr(seg, &hdr);
+        if (ret == -ENODATA) continue;
+        if (ret != 0) goto out;
+        used++;
+        if (head == RAWLOG_NONE || (int32_t)(hdr.seq - head_seq) > 0) {
+            head = seg;
+            head_seq = hdr.seq;
+        }
     }
     
-    /* Init Flash2 (QSPI) */
-    if (flash2_init() != 0) {
-        LOG_ERR("FLASH2 init failed");
-        return -EIO;
+    /* Walk the head segment to the end of written data */
+    while (head != RAWLOG_NONE) {
+        int n = rawlog_read_rec_hdr(head, off, &rec);
+        if (n == -EBADMSG) {
+            damaged++;
+            off = RAWLOG_SEG_SIZE;    /* Next append opens a new segment */
+            break;
+        }
+        if (n <= 0) {
+            ret = n;
+            if (n < 0) goto out;
+            break;
+        }
+        ret = rawlog_check_payload(head, off, &rec);
+        if (ret == -EBADMSG) {
+            damaged++;
+        } else if (ret != 0) {
+            goto out;
+        }
+        off += n;
     }
     
-    /* Setup LittleFS buffers */
-    lfs_cfg1.read_buffer = lfs1_read_buf;
-    lfs_cfg1.prog_buffer = lfs1_prog_buf;
-    lfs_cfg1.lookahead_buffer = lfs1_look_buf;
+    rawlog.head = head;
+    rawlog.head_seq = head_seq;
+    rawlog.head_off = off;
+    rawlog.used = used;
+    rawlog.next_ready = 0;
+    ret = damaged;
+    LOG_INF("FLASH2: Raw log %u/%u segments, %u bytes in head, %d damaged", used,
+            NOR_FLASH_RAWLOG_SEGMENTS, (head != RAWLOG_NONE) ? off : 0, damaged);
     
-    lfs_cfg2.read_buffer = lfs2_read_buf;
-    lfs_cfg2.prog_buffer = lfs2_prog_buf;
-    lfs_cfg2.lookahead_buffer = lfs2_look_buf;
+out:
+    k_mutex_unlock(&rawlog_lock);
+    return ret;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+int nor_flash_rawlog_append(const void *data, size_t len, uint32_t time)
+{
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+    const uint8_t *src = data;
+    int ret = 0;
     
-    /* Mount filesystems */
-    if (lfs_init_mount(&lfs1, &lfs_cfg1, "FLASH1") != 0) return -EIO;
-    if (lfs_init_mount(&lfs2, &lfs_cfg2, "FLASH2") != 0) return -EIO;
+    if (data == NULL && len > 0) return -EINVAL;
+    if (!flash2_initialized) return -ENODEV;
     
-    LOG_INF("Dual flash system ready - Total: %d MB", FLASH1_SIZE_MB + FLASH2_SIZE_MB);
-    return 0;
+    k_mutex_lock(&rawlog_lock, K_FOREVER);
+    while (len > 0) {
+        /* Records never cross a segment end; split the data instead */
+        if (rawlog.head == RAWLOG_NONE || rawlog.head_off + RAWLOG_REC_SIZE(1) > RAWLOG_SEG_SIZE) {
+            ret = rawlog_advance(time);
+            if (ret != 0) break;
+        }
+        size_t room = RAWLOG_SEG_SIZE - rawlog.head_off - sizeof(struct rawlog_rec_hdr);
+        size_t n = MIN(MIN(len, room), UINT16_MAX);
+        struct rawlog_rec_hdr rec = {
+            .time = time, .len = n, .len_inv = (uint16_t)~n, .crc = lfs_crc(0xFFFFFFFF, src, n),
+        };
+        uint32_t addr = rawlog_addr(rawlog.head, rawlog.head_off);
+        
+        /* Header first, so a torn payload can still be skipped by length */
+        ret = flash_write(flash2_dev, addr, &rec, sizeof(rec));
+        if (ret == 0) ret = flash_write(flash2_dev, addr + sizeof(rec), src, n);
+        if (ret != 0) {
+            rawlog.head_off = RAWLOG_SEG_SIZE;    /* Never program over a partial record */
+            break;
+        }
+        rawlog.head_off += RAWLOG_REC_SIZE(n);
+        src += n;
+        len -= n;
+    }
+    k_mutex_unlock(&rawlog_lock);
+    return ret;
+#else
+    return -ENOTSUP;
+#endif
 }
 
-int nor_flash_write_file(flash_device_t device, const char *filename, const void *data, size_t len)
+int nor_flash_rawlog_seek(uint32_t time, struct nor_flash_rawlog_pos *pos)
 {
-    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
-    lfs_file_t file;
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+    struct rawlog_seg_hdr hdr;
+    struct rawlog_rec_hdr rec;
+    int ret = 0;
     
-    int ret = lfs_file_open(lfs, &file, filename, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC);
-    if (ret < 0) return ret;
+    if (pos == NULL) return -EINVAL;
+    if (!flash2_initialized) return -ENODEV;
     
-    ret = lfs_file_write(lfs, &file, data, len);
-    lfs_file_close(lfs, &file);
+    k_mutex_lock(&rawlog_lock, K_FOREVER);
+    if (rawlog.head == RAWLOG_NONE) {
+        ret = -ENODATA;
+        goto out;
+    }
     
-    if (ret >= 0) {
-        LOG_INF("FLASH%d: Wrote %s (%zu bytes)", device + 1, filename, len);
+    /* Last segment that starts at or before time (timestamps are non-decreasing) */
+    uint32_t lo = 0, hi = rawlog.used;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        ret = rawlog_read_seg_hdr(rawlog_seg_at(mid), &hdr);
+        if (ret != 0) goto out;
+        if ((int32_t)(hdr.time - time) <= 0) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
     }
-    return (ret >= 0) ? 0 : ret;
+    
+    /* Then the first record in it at or after time */
+    pos->seg = rawlog_seg_at(lo);
+    pos->off = sizeof(hdr);
+    while (true) {
+        int n = rawlog_read_rec_hdr(pos->seg, pos->off, &rec);
+        if (n < 0 && n != -EBADMSG) {
+            ret = n;
+            goto out;
+        }
+        if (n <= 0) {
+            /* Ran off the segment: the match is the next one's first record */
+            if (pos->seg != rawlog.head) {
+                pos->seg = rawlog_seg_at(lo + 1);
+                pos->off = sizeof(hdr);
+            }
+            break;
+        }
+        if ((int32_t)(rec.time - time) >= 0) break;
+        pos->off += n;
+    }
+    ret = 0;
+    
+out:
+    k_mutex_unlock(&rawlog_lock);
+    return ret;
+#else
+    return -ENOTSUP;
+#endif
 }
 
-int nor_flash_read_file(flash_device_t device, const char *filename, void *buffer, size_t len)
+int nor_flash_rawlog_read(struct nor_flash_rawlog_pos *pos, void *buf, size_t len, uint32_t *time)
 {
-    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
-    lfs_file_t file;
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+    struct rawlog_rec_hdr rec;
+    int ret, n;
     
-    int ret = lfs_file_open(lfs, &file, filename, LFS_O_RDONLY);
-    if (ret < 0) return ret;
+    if (pos == NULL || buf == NULL || pos->seg >= NOR_FLASH_RAWLOG_SEGMENTS) return -EINVAL;
+    if (!flash2_initialized) return -ENODEV;
     
-    ret = lfs_file_read(lfs, &file, buffer, len);
-    lfs_file_close(lfs, &file);
+    k_mutex_lock(&rawlog_lock, K_FOREVER);
+    if (rawlog.head == RAWLOG_NONE) {
+        ret = 0;
+        goto out;
+    }
     
-    if (ret >= 0) {
-        LOG_INF("FLASH%d: Read %s (%d bytes)", device + 1, filename, ret);
+    /* Step over segment ends until a record or the head's end */
+    while ((n = rawlog_read_rec_hdr(pos->seg, pos->off, &rec)) <= 0) {
+        if (n < 0 && n != -EBADMSG) {
+            ret = n;
+            goto out;
+        }
+        if (pos->seg == rawlog.head) {
+            ret = 0;
+            goto out;
+        }
+        pos->seg = (pos->seg + 1) % NOR_FLASH_RAWLOG_SEGMENTS;
+        pos->off = sizeof(struct rawlog_seg_hdr);
     }
+    
+    if (rec.len > len) {
+        ret = -EMSGSIZE;
+        goto out;
+    }
+    ret = flash_read(flash2_dev, rawlog_addr(pos->seg, pos->off) + sizeof(rec), buf, rec.len);
+    if (ret != 0) goto out;
+    
+    ret = (lfs_crc(0xFFFFFFFF, buf, rec.len) == rec.crc) ? rec.len : -EBADMSG;
+    if (time != NULL) *time = rec.time;
+    pos->off += n;
+    
+out:
+    k_mutex_unlock(&rawlog_lock);
     return ret;
+#else
+    return -ENOTSUP;
+#endif
 }
 
-int nor_flash_write_struct(flash_device_t device, const char *filename, const void *data, size_t size)
+int nor_flash_rawlog_clear(void)
 {
-    return nor_flash_write_file(device, filename, data, size);
+#if NOR_FLASH_RAWLOG_SEGMENTS > 0
+    if (!flash2_initialized) return -ENODEV;
+    
+    k_mutex_lock(&rawlog_lock, K_FOREVER);
+    int ret = erase_range_counted(FLASH2, RAWLOG_BASE, NOR_FLASH_RAWLOG_SEGMENTS * RAWLOG_SEG_SIZE);
+    if (ret == 0) {
+        rawlog.head = RAWLOG_NONE;
+        rawlog.head_off = 0;
+        rawlog.used = 0;
+        rawlog.next_ready = RAWLOG_SEG_BLOCKS;    /* Segment 0 is erased now */
+    }
+    k_mutex_unlock(&rawlog_lock);
+    return ret;
+#else
+    return -ENOTSUP;
+#endif
 }
 
-int nor_flash_read_struct(flash_device_t device, const char *filename, void *buffer, size_t size)
+bool nor_flash_is_readonly(flash_device_t device)
 {
-    int ret = nor_flash_read_file(device, filename, buffer, size);
-    if (ret < 0) return ret;
-    if ((size_t)ret != size) {
-        LOG_ERR("Size mismatch: expected %zu, got %d", size, ret);
-        return -EIO;
-    }
-    return 0;
+    return (device == FLASH1) ? lfs1_readonly : lfs2_readonly;
 }
 
 const char* nor_flash_get_device_name(flash_device_t device)
@@ -474,6 +2366,8 @@ int nor_flash_get_file_size(flash_device_t device, const char *filename)
     lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
     struct lfs_info info;
     
+    if (!lfs_is_mounted(device)) return -ENODEV;
+    
     int ret = lfs_stat(lfs, filename, &info);
     if (ret < 0) {
         return ret;  /* File not found or error */
@@ -486,5 +2380,416 @@ int nor_flash_get_file_size(flash_device_t device, const char *filename)
     return (int)info.size;
 }
 
+#if NOR_FLASH_TIME_INDEX_KB > 0
+static nor_flash_time_fn_t time_source;
+
+/* Add an entry once the write position is an interval past the last one */
+static void time_index_note(struct nor_flash_file *h)
+{
+    struct time_index *idx = &h->index;
+    lfs_soff_t pos = lfs_file_size(h->lfs, &h->file);    /* Writers only append */
+    
+    if (pos < 0) return;
+    if (idx->count > 0 && (uint32_t)pos < idx->entry[idx->count - 1].off + idx->interval) return;
+    
+    if (idx->count == NOR_FLASH_TIME_INDEX_ENTRIES) {
+        /* Full: keep every other entry at twice the spacing */
+        for (uint32_t i = 1; i < idx->count / 2; i++) {
+            idx->entry[i] = idx->entry[2 * i];
+        }
+        idx->count /= 2;
+        idx->interval *= 2;
+        if ((uint32_t)pos < idx->entry[idx->count - 1].off + idx->interval) goto out;
+    }
+    idx->entry[idx->count++] = (struct time_index_entry){.time = time_source(), .off = (uint32_t)pos};
+    
+out:
+    h->index_attr.size = TIME_INDEX_SIZE(idx->count);
+}
+
+/* Record where the data ends before the index is committed */
+static void time_index_end(struct nor_flash_file *h)
+{
+    lfs_soff_t size = lfs_file_size(h->lfs, &h->file);
+    
+    if (size < 0 || h->index.count == 0) return;
+    h->index.end_time = time_source();
+    h->index.end_off = (uint32_t)size;
+}
+#endif
+
+void nor_flash_set_time_source(nor_flash_time_fn_t now)
+{
+#if NOR_FLASH_TIME_INDEX_KB > 0
+    time_source = now;
+#endif
+}
+
+int nor_flash_seek_time(nor_flash_file_t *handle, const struct tm *when)
+{
+#if NOR_FLASH_TIME_INDEX_KB > 0
+    if (handle == NULL || when == NULL) return -EINVAL;
+    if ((handle->file.flags & LFS_O_RDWR) != LFS_O_RDONLY) return -EBADF;
+    
+    const struct time_index *idx = &handle->index;
+    uint32_t t = (uint32_t)timeutil_timegm64(when);
+    
+    if (idx->count == 0 || idx->count > NOR_FLASH_TIME_INDEX_ENTRIES) return -ENODATA;
+    if (t < idx->entry[0].time || t > MAX(idx->end_time, idx->entry[idx->count - 1].time)) return -ERANGE;
+    
+    /* Last entry at or before t, and the next point (entry or end of data) */
+    uint32_t i = 0;
+    while (i + 1 < idx->count && idx->entry[i + 1].time <= t) i++;
+    struct time_index_entry a = idx->entry[i];
+    struct time_index_entry b = (i + 1 < idx->count) ? idx->entry[i + 1]
+                              : (struct time_index_entry){.time = idx->end_time, .off = idx->end_off};
+    
+    /* Recordings have a steady data rate, so interpolate within the interval */
+    uint32_t off = a.off;
+    if (b.time > a.time && b.off > a.off) {
+        off += (uint32_t)((uint64_t)(t - a.time) * (b.off - a.off) / (b.time - a.time));
+    }
+    
+    lfs_soff_t pos = lfs_file_seek(handle->lfs, &handle->file, off, LFS_SEEK_SET);
+    return (pos < 0) ? (int)pos : (int)off;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+int nor_flash_open(flash_device_t device, const char *filename, nor_flash_mode_t mode,
+                   nor_flash_file_t **handle)
+{
+    struct nor_flash_file *h = NULL;
+    int flags;
+    
+    switch (mode) {
+    case NOR_FLASH_MODE_READ:   flags = LFS_O_RDONLY; break;
+    case NOR_FLASH_MODE_APPEND: flags = LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND; break;
+    case NOR_FLASH_MODE_WRITE:  flags = LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC; break;
+    default: return -EINVAL;
+    }
+    if (!lfs_is_mounted(device)) return -ENODEV;
+    
+    for (size_t i = 0; i < ARRAY_SIZE(file_pool); i++) {
+        if (atomic_cas(&file_pool[i].in_use, 0, 1)) {
+            h = &file_pool[i];
+            break;
+        }
+    }
+    if (h == NULL) return -ENFILE;
+    
+    h->device = device;
+    h->lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    h->cfg = (struct lfs_file_config){.buffer = h->cache};
+#if NOR_FLASH_TIME_INDEX_KB > 0
+    /* Readers load the time index at open; writers commit it on each sync */
+    memset(&h->index, 0, sizeof(h->index));
+    h->indexing = (mode != NOR_FLASH_MODE_READ) && (time_source != NULL);
+    if (mode == NOR_FLASH_MODE_APPEND && h->indexing) {
+        lfs_ssize_t n = lfs_getattr(h->lfs, filename, TIME_INDEX_ATTR, &h->index, sizeof(h->index));
+        if (n < (lfs_ssize_t)TIME_INDEX_SIZE(0) || h->index.count > NOR_FLASH_TIME_INDEX_ENTRIES) {
+            memset(&h->index, 0, sizeof(h->index));
+        }
+    }
+    if (h->index.interval == 0) h->index.interval = NOR_FLASH_TIME_INDEX_KB * 1024;
+    if (mode == NOR_FLASH_MODE_READ || h->indexing) {
+        h->index_attr = (struct lfs_attr){
+            .type = TIME_INDEX_ATTR, .buffer = &h->index,
+            .size = h->indexing ? TIME_INDEX_SIZE(h->index.count) : sizeof(h->index),
+        };
+        h->cfg.attrs = &h->index_attr;
+        h->cfg.attr_count = 1;
+    }
+#endif
+    
+    int ret = lfs_file_opencfg(h->lfs, &h->file, filename, flags, &h->cfg);
+    if (ret < 0) {
+        atomic_set(&h->in_use, 0);
+        return ret;
+    }
+    
+    *handle = h;
+    return 0;
+}
+
+int nor_flash_append(nor_flash_file_t *handle, const void *data, size_t len)
+{
+#if NOR_FLASH_TIME_INDEX_KB > 0
+    if (handle->indexing) time_index_note(handle);
+#endif
+    lfs_ssize_t ret = lfs_file_write(handle->lfs, &handle->file, data, len);
+    return (ret < 0) ? (int)ret : 0;
+}
+
+int nor_flash_sync(nor_flash_file_t *handle)
+{
+#if NOR_FLASH_TIME_INDEX_KB > 0
+    if (handle->indexing) time_index_end(handle);
+#endif
+    return lfs_file_sync(handle->lfs, &handle->file);
+}
+
+int nor_flash_close(nor_flash_file_t *handle)
+{
+#if NOR_FLASH_TIME_INDEX_KB > 0
+    if (handle->indexing) time_index_end(handle);
+#endif
+    int ret = lfs_file_close(handle->lfs, &handle->file);
+    atomic_set(&handle->in_use, 0);
+    return ret;
+}
+
+int nor_flash_read_at(nor_flash_file_t *handle, uint32_t offset, void *buf, size_t len)
+{
+    lfs_soff_t pos = lfs_file_seek(handle->lfs, &handle->file, offset, LFS_SEEK_SET);
+    if (pos < 0) return (int)pos;
+    
+    return (int)lfs_file_read(handle->lfs, &handle->file, buf, len);
+}
+
+int nor_flash_read_stream(flash_device_t device, const char *filename, void *window, size_t window_len,
+                          nor_flash_read_cb_t cb, void *user_data)
+{
+    nor_flash_file_t *h;
+    uint32_t offset = 0;
+    
+    if (window == NULL || window_len == 0 || cb == NULL) return -EINVAL;
+    if (!lfs_is_mounted(device)) return -ENODEV;
+    
+    int ret = nor_flash_open(device, filename, NOR_FLASH_MODE_READ, &h);
+    if (ret < 0) return ret;
+    
+    while (true) {
+        lfs_ssize_t n = lfs_file_read(h->lfs, &h->file, window, window_len);
+        if (n <= 0) {
+            ret = (int)n;
+            break;
+        }
+        ret = cb(window, (size_t)n, offset, user_data);
+        if (ret != 0) break;
+        offset += n;
+    }
+    
+    nor_flash_close(h);
+    return ret;
+}
+
+/* What the raw program and erase calls may touch: the raw region, or
+ * LittleFS blocks while the device is not mounted. Never the raw log or the
+ * wear table above them, which only the driver itself writes. */
+static bool raw_access_allowed(flash_device_t device, uint32_t addr, size_t len)
+{
+    uint32_t lfs_end = ((device == FLASH1) ? FLASH1_LFS_BLOCKS : FLASH2_LFS_BLOCKS) * FLASH_SECTOR_SIZE;
+    uint32_t raw_end = lfs_end + ((device == FLASH1) ? FLASH1_RAW_BLOCKS : FLASH2_RAW_BLOCKS) * FLASH_SECTOR_SIZE;
+    bool mounted = (device == FLASH1) ? lfs1_mounted : lfs2_mounted;
+    
+    if (len > raw_end || addr > raw_end - len) return false;
+    return addr >= lfs_end || !mounted;
+}
+
+int nor_flash_prog_async(flash_device_t device, uint32_t addr, const void *data, size_t len,
+                         nor_flash_prog_cb_t cb, void *user_data, struct k_poll_signal *signal)
+{
+    bool ready = (device == FLASH1) ? flash1.initialized : flash2_initialized;
+    uint32_t size = nor_flash_get_device_size(device);
+    if (!ready) return -ENODEV;
+    if (data == NULL || len == 0) return -EINVAL;
+    if (len > size || addr > size - len) return -EINVAL;
+    if (!raw_access_allowed(device, addr, len)) return -EACCES;
+    
+    struct prog_async_req req = {
+        .device = device, .addr = addr, .data = data, .len = len,
+        .cb = cb, .user_data = user_data, .signal = signal,
+    };
+    return k_msgq_put(&prog_async_queue, &req, K_NO_WAIT);
+}
+
+int nor_flash_prog_async_flush(void)
+{
+    struct k_poll_signal done;
+    struct k_poll_event evt;
+    
+    /* Queue is FIFO, so an empty request completes after everything before it */
+    k_poll_signal_init(&done);
+    k_poll_event_init(&evt, K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY, &done);
+    
+    struct prog_async_req req = {.signal = &done};
+    int ret = k_msgq_put(&prog_async_queue, &req, K_FOREVER);
+    if (ret != 0) return ret;
+    
+    return k_poll(&evt, 1, K_FOREVER);
+}
+
+static int erase_range_raw(flash_device_t device, uint32_t addr, size_t len)
+{
+    uint32_t size = nor_flash_get_device_size(device);
+    
+    if ((addr % FLASH_SECTOR_SIZE) != 0 || (len % FLASH_SECTOR_SIZE) != 0) return -EINVAL;
+    if (len == 0 || len > size || addr > size - len) return -EINVAL;
+    
+    if (device == FLASH1) {
+        if (!flash1.initialized) return -ENODEV;
+        return flash1_erase_range(addr, len);
+    }
+    
+    /* The nordic,qspi-nor driver already uses chip erase for the whole device
+     * and 64KB block erase for aligned spans. It has no suspend support, so
+     * partial ranges go in 64KB steps and reads can run between blocks. */
+    if (!flash2_initialized) return -ENODEV;
+    if (addr == 0 && len == size) {
+        return flash_erase(flash2_dev, addr, len);
+    }
+    while (len > 0) {
+        size_t step = MIN(len, FLASH_BLOCK_SIZE_64K - (addr % FLASH_BLOCK_SIZE_64K));
+        int ret = flash_erase(flash2_dev, addr, step);
+        if (ret != 0) return ret;
+        addr += step;
+        len -= step;
+    }
+    return 0;
+}
+
+/* Any range, counted in the wear table; for the driver's own regions */
+static int erase_range_counted(flash_device_t device, uint32_t addr, size_t len)
+{
+    int ret = erase_range_raw(device, addr, len);
+#if NOR_FLASH_WEAR_TRACK
+    if (ret == 0) wear_note_erase(device, addr / FLASH_SECTOR_SIZE, len / FLASH_SECTOR_SIZE);
+#endif
+    return ret;
+}
+
+int nor_flash_erase_range(flash_device_t device, uint32_t addr, size_t len)
+{
+    uint32_t size = nor_flash_get_device_size(device);
+    
+    if (len > size || addr > size - len) return -EINVAL;
+    if (!raw_access_allowed(device, addr, len)) return -EACCES;
+    return erase_range_counted(device, addr, len);
+}
+
+int nor_flash_format(flash_device_t device, bool wipe)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    struct lfs_config *cfg = (device == FLASH1) ? &lfs_cfg1 : &lfs_cfg2;
+    struct k_mutex *lock = (device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+    bool *mounted = (device == FLASH1) ? &lfs1_mounted : &lfs2_mounted;
+    const char *name = (device == FLASH1) ? "FLASH1" : "FLASH2";
+    bool ready = (device == FLASH1) ? flash1.initialized : flash2_initialized;
+    int ret = 0;
+    
+    if (!ready) return -ENODEV;
+    
+    k_mutex_lock(lock, K_FOREVER);
+    if (*mounted) {
+        lfs_unmount(lfs);
+        *mounted = false;
+    }
+    *((device == FLASH1) ? &lfs1_readonly : &lfs2_readonly) = false;
+    
+    if (wipe) {
+        /* Only the LittleFS range: anything above it (wear table, raw log)
+         * must survive, so this is a chip erase only if nothing is there */
+        uint32_t start = k_uptime_get_32();
+        ret = nor_flash_erase_range(device, 0, cfg->block_count * cfg->block_size);
+        if (ret != 0) {
+            LOG_ERR("%s: Wipe failed (%d)", name, ret);
+            goto out;
+        }
+#if NOR_FLASH_PREERASE_POOL > 0
+        memset((device == FLASH1) ? lfs1_erased_map : lfs2_erased_map, 0xFF,
+               (device == FLASH1) ? sizeof(lfs1_erased_map) : sizeof(lfs2_erased_map));
+#endif
+        LOG_INF("%s: Wiped in %u ms", name, k_uptime_get_32() - start);
+    }
+    
+    ret = lfs_format(lfs, cfg);
+    if (ret != LFS_ERR_OK) {
+        LOG_ERR("%s: Format failed (%d)", name, ret);
+        ret = -EIO;
+        goto out;
+    }
+    
+    ret = lfs_mount(lfs, cfg);
+    if (ret != LFS_ERR_OK) {
+        LOG_ERR("%s: Mount after format failed (%d)", name, ret);
+        ret = -EIO;
+        goto out;
+    }
+    
+    *mounted = true;
+    LOG_INF("%s: LittleFS formatted and mounted", name);
+out:
+    k_mutex_unlock(lock);
+    return ret;
+}
+
+int nor_flash_snapshot_save(flash_device_t device)
+{
+#if NOR_FLASH_MOUNT_SNAPSHOT
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    struct lfs_config *cfg = (device == FLASH1) ? &lfs_cfg1 : &lfs_cfg2;
+    struct k_mutex *lock = (device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+    bool *mounted = (device == FLASH1) ? &lfs1_mounted : &lfs2_mounted;
+    struct lfs_snapshot *snap = (device == FLASH1) ? &lfs1_snap : &lfs2_snap;
+    uint32_t *map = (device == FLASH1) ? lfs1_snap_map : lfs2_snap_map;
+    size_t map_len = (device == FLASH1) ? sizeof(lfs1_snap_map) : sizeof(lfs2_snap_map);
+    uint32_t *gen = (device == FLASH1) ? &lfs1_snap_gen : &lfs2_snap_gen;
+    int ret;
+    
+    k_mutex_lock(lock, K_FOREVER);
+    snap->magic = 0;
+    if (!*mounted) {
+        ret = -ENODEV;
+        goto out;
+    }
+    if (lfs->mlist != NULL) {
+        ret = -EBUSY;
+        goto out;
+    }
+    if (lfs->free.size == 0) {
+        ret = -ENODATA;
+        goto out;
+    }
+    
+    struct lfs_snapshot cur = {
+        .magic = SNAPSHOT_MAGIC,
+        .generation = *gen + 1,
+        .block_count = cfg->block_count,
+        .off = lfs->free.off,
+        .size = lfs->free.size,
+        .i = lfs->free.i,
+    };
+    memcpy(map, lfs->free.buffer, map_len);
+    
+    /* Remount to get the seed the next boot's mount will compute */
+    lfs_unmount(lfs);
+    ret = lfs_mount(lfs, cfg);
+    if (ret != LFS_ERR_OK) {
+        *mounted = false;
+        LOG_ERR("FLASH%d: Remount for snapshot failed (%d)", device + 1, ret);
+        goto out;
+    }
+    cur.seed = lfs->seed;
+    cur.crc = snapshot_crc(&cur, map, map_len);
+    *snap = cur;
+    *gen = cur.generation;
+    lfs_snap_expect[device][0] = cur.generation;
+    lfs_snap_expect[device][1] = ~cur.generation;
+    
+    /* Same flash contents, so the saved cursor is still valid for this mount */
+    snapshot_restore(device);
+    snap->magic = SNAPSHOT_MAGIC;
+    ret = 0;
+    
+out:
+    k_mutex_unlock(lock);
+    return ret;
+#else
+    return -ENOTSUP;
+#endif
+}
+
 int nor_flash_basic_init(void) { return nor_flash_system_init(); }
 int nor_flash_basic_test(void) { return 0; }
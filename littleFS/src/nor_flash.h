@@ -9,12 +9,17 @@
  * Configure flash sizes in CMakeLists.txt:
  * - FLASH1_SIZE_MB: 64, 32, or 16 (default: 16)
  * - FLASH2_SIZE_MB: 64, 32, or 16 (default: 64)
+ * - FLASH1_READ_MODE: 0 = auto (FAST_READ only if the SPIM clock can exceed 50MHz and
+ *   the chip has SFDP), 1 = READ 0x03, 2 = FAST_READ 0x0B (default: 0)
+ * - FLASHn_LFS_READ_SIZE / _PROG_SIZE / _CACHE_SIZE / _LOOKAHEAD_SIZE / _METADATA_MAX:
+ *   per-device LittleFS geometry (see below)
  */
 
 #ifndef NOR_FLASH_H
 #define NOR_FLASH_H
 
 #include <zephyr/kernel.h>
+#include <time.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,6 +34,19 @@ extern "C" {
 #define FLASH2_SIZE_MB 64  /* Default: 64MB for Flash2 (QSPI hardware) */
 #endif
 
+/* Flash1 read engine selection - set via CMakeLists.txt */
+#define FLASH1_READ_MODE_AUTO    0
+#define FLASH1_READ_MODE_NORMAL  1  /* 0x03, no dummy cycles, up to 50MHz */
+#define FLASH1_READ_MODE_FAST    2  /* 0x0B, 8 dummy cycles, up to 133MHz */
+
+#ifndef FLASH1_READ_MODE
+#define FLASH1_READ_MODE FLASH1_READ_MODE_AUTO
+#endif
+
+#if FLASH1_READ_MODE < FLASH1_READ_MODE_AUTO || FLASH1_READ_MODE > FLASH1_READ_MODE_FAST
+#error "FLASH1_READ_MODE must be 0 (auto), 1 (normal) or 2 (fast)"
+#endif
+
 /* Calculate flash parameters based on size */
 #if FLASH1_SIZE_MB == 64
 #define FLASH1_CHIP_NAME         "MX25L51245GZ2I-08G"
@@ -68,14 +86,296 @@ extern "C" {
 #define FLASH_BLOCK_SIZE_32K     32768
 #define FLASH_BLOCK_SIZE_64K     65536
 
+/*
+ * Per-device LittleFS geometry - set via CMakeLists.txt
+ * READ_SIZE:      smallest read LittleFS issues (NOR reads are byte-addressable)
+ * PROG_SIZE:      program granularity, at most one page
+ * CACHE_SIZE:     read/prog/file cache, multiple of both sizes above, up to 4KB
+ * LOOKAHEAD_SIZE: allocator bitmap in bytes (8 blocks per byte); the default
+ *                 covers the whole device so one scan finds every free block
+ * METADATA_MAX:   cap on metadata pair size, 0 = block size; smaller values
+ *                 bound compaction time at the cost of more metadata blocks
+ * BLOCK_CYCLES:   erases of a metadata pair before LittleFS moves it (dynamic
+ *                 wear leveling); tune from nor_flash_get_wear()
+ */
+#ifndef FLASH1_LFS_READ_SIZE
+#define FLASH1_LFS_READ_SIZE       16
+#endif
+#ifndef FLASH1_LFS_PROG_SIZE
+#define FLASH1_LFS_PROG_SIZE       FLASH_PAGE_SIZE
+#endif
+#ifndef FLASH1_LFS_CACHE_SIZE
+#define FLASH1_LFS_CACHE_SIZE      1024
+#endif
+#ifndef FLASH1_LFS_LOOKAHEAD_SIZE
+#define FLASH1_LFS_LOOKAHEAD_SIZE  (FLASH1_CHIP_SIZE_BYTES / FLASH_SECTOR_SIZE / 8)
+#endif
+#ifndef FLASH1_LFS_METADATA_MAX
+#define FLASH1_LFS_METADATA_MAX    0
+#endif
+#ifndef FLASH1_LFS_BLOCK_CYCLES
+#define FLASH1_LFS_BLOCK_CYCLES    100000
+#endif
+
+#ifndef FLASH2_LFS_READ_SIZE
+#define FLASH2_LFS_READ_SIZE       16
+#endif
+#ifndef FLASH2_LFS_PROG_SIZE
+#define FLASH2_LFS_PROG_SIZE       FLASH_PAGE_SIZE
+#endif
+#ifndef FLASH2_LFS_CACHE_SIZE
+#define FLASH2_LFS_CACHE_SIZE      1024
+#endif
+#ifndef FLASH2_LFS_LOOKAHEAD_SIZE
+#define FLASH2_LFS_LOOKAHEAD_SIZE  (FLASH2_CHIP_SIZE_BYTES / FLASH_SECTOR_SIZE / 8)
+#endif
+#ifndef FLASH2_LFS_METADATA_MAX
+#define FLASH2_LFS_METADATA_MAX    0
+#endif
+#ifndef FLASH2_LFS_BLOCK_CYCLES
+#define FLASH2_LFS_BLOCK_CYCLES    100000
+#endif
+
+#if (FLASH1_LFS_CACHE_SIZE % FLASH1_LFS_READ_SIZE) || (FLASH1_LFS_CACHE_SIZE % FLASH1_LFS_PROG_SIZE) || \
+    (FLASH_SECTOR_SIZE % FLASH1_LFS_CACHE_SIZE) || (FLASH1_LFS_PROG_SIZE > FLASH_PAGE_SIZE)
+#error "FLASH1_LFS_CACHE_SIZE must be a multiple of READ/PROG_SIZE and divide the 4KB sector"
+#endif
+#if (FLASH2_LFS_CACHE_SIZE % FLASH2_LFS_READ_SIZE) || (FLASH2_LFS_CACHE_SIZE % FLASH2_LFS_PROG_SIZE) || \
+    (FLASH_SECTOR_SIZE % FLASH2_LFS_CACHE_SIZE) || (FLASH2_LFS_PROG_SIZE > FLASH_PAGE_SIZE)
+#error "FLASH2_LFS_CACHE_SIZE must be a multiple of READ/PROG_SIZE and divide the 4KB sector"
+#endif
+#if (FLASH1_LFS_LOOKAHEAD_SIZE % 8) || (FLASH2_LFS_LOOKAHEAD_SIZE % 8)
+#error "FLASHn_LFS_LOOKAHEAD_SIZE must be a multiple of 8"
+#endif
+#if (FLASH1_LFS_METADATA_MAX > FLASH_SECTOR_SIZE) || (FLASH2_LFS_METADATA_MAX > FLASH_SECTOR_SIZE)
+#error "FLASHn_LFS_METADATA_MAX must not exceed the 4KB block size"
+#endif
+
 /* Flash selection for operations */
 typedef enum {
     FLASH1 = 0,    /* SPIFX interface (SPI1 in QSPI mode) - default 16MB */
     FLASH2 = 1     /* QSPI interface (hardware QSPI) - default 64MB */
 } flash_device_t;
 
-/* Public API Functions */
+/* Asynchronous programming queue - set via CMakeLists.txt */
+#ifndef NOR_FLASH_PROG_QUEUE_DEPTH
+#define NOR_FLASH_PROG_QUEUE_DEPTH  8
+#endif
+
+#ifndef NOR_FLASH_PROG_STACK_SIZE
+#define NOR_FLASH_PROG_STACK_SIZE   1024
+#endif
+
+#ifndef NOR_FLASH_PROG_PRIORITY
+#define NOR_FLASH_PROG_PRIORITY     5
+#endif
+
+/*
+ * Raw region per device for nor_flash_prog_async(), in KB (multiple of 4) -
+ * set via CMakeLists.txt. It sits directly above LittleFS and comes out of
+ * its block range, so changing it needs nor_flash_format().
+ */
+#ifndef FLASH1_RAW_KB
+#define FLASH1_RAW_KB  0
+#endif
+
+#ifndef FLASH2_RAW_KB
+#define FLASH2_RAW_KB  0
+#endif
+
+#if (FLASH1_RAW_KB % 4) || (FLASH2_RAW_KB % 4) || \
+    (FLASH1_RAW_KB > FLASH1_SIZE_MB * 1024 / 2) || (FLASH2_RAW_KB > FLASH2_SIZE_MB * 1024 / 2)
+#error "FLASHn_RAW_KB must be a multiple of 4 and leave at least half of the device to LittleFS"
+#endif
+
+/* Maximum simultaneously open nor_flash_open() handles - set via CMakeLists.txt */
+#ifndef NOR_FLASH_MAX_OPEN_FILES
+#define NOR_FLASH_MAX_OPEN_FILES  4
+#endif
+
+/* Background pre-erase pool - set via CMakeLists.txt (0 disables) */
+#ifndef NOR_FLASH_PREERASE_POOL
+#define NOR_FLASH_PREERASE_POOL         8    /* Free blocks kept erased per device */
+#endif
+
+#ifndef NOR_FLASH_PREERASE_INTERVAL_MS
+#define NOR_FLASH_PREERASE_INTERVAL_MS  100  /* Re-check period once the pool is full */
+#endif
+
+#ifndef NOR_FLASH_PREERASE_STACK_SIZE
+#define NOR_FLASH_PREERASE_STACK_SIZE   1024
+#endif
+
+/* Mount attempts after the first that are preceded by a flash bus reset */
+#ifndef NOR_FLASH_MOUNT_RETRIES
+#define NOR_FLASH_MOUNT_RETRIES   2
+#endif
+
+/*
+ * Provisioning - set via CMakeLists.txt. 0 = only nor_flash_format() formats.
+ * 1 = a device that does not mount is formatted if its whole LittleFS range
+ * reads erased (a new chip; the check stops at the first written byte). A
+ * dead or floating bus reads all 0xFF too, so the format also needs a bus
+ * reset and an ID check (RDID manufacturer, SFDP signature; FLASH2 needs
+ * CONFIG_FLASH_JESD216_API) to succeed just before it. For provisioning
+ * builds; field builds keep 0.
+ */
+#ifndef NOR_FLASH_FORMAT_BLANK
+#define NOR_FLASH_FORMAT_BLANK    0
+#endif
+
+/* Per-device operation counters and latency histograms - set via CMakeLists.txt */
+#ifndef NOR_FLASH_STATS
+#define NOR_FLASH_STATS           1
+#endif
+
+/*
+ * Per-block erase counters - set via CMakeLists.txt. Counts are kept in RAM
+ * and written in batches to an A/B region at the top of each device, which
+ * is taken out of the LittleFS block range: toggling this changes
+ * block_count, so existing filesystems no longer mount and need
+ * nor_flash_format(). Off by default so deployed units keep their data.
+ */
+#ifndef NOR_FLASH_WEAR_TRACK
+#define NOR_FLASH_WEAR_TRACK      0
+#endif
+
+#ifndef NOR_FLASH_WEAR_BATCH
+#define NOR_FLASH_WEAR_BATCH      1024  /* Pending erases that trigger a write-back */
+#endif
+
+#ifndef NOR_FLASH_WEAR_STACK_SIZE
+#define NOR_FLASH_WEAR_STACK_SIZE 1024  /* Write-back work queue */
+#endif
+
+/*
+ * Raw recording log on FLASH2 in 64KB segments - set via CMakeLists.txt,
+ * 0 disables it. The segments come out of the LittleFS range on FLASH2, so
+ * changing this needs nor_flash_format(FLASH2).
+ */
+#ifndef NOR_FLASH_RAWLOG_SEGMENTS
+#define NOR_FLASH_RAWLOG_SEGMENTS 0
+#endif
+
+/* 1 = reclaim the oldest segment when the raw log is full, 0 = -ENOSPC */
+#ifndef NOR_FLASH_RAWLOG_WRAP
+#define NOR_FLASH_RAWLOG_WRAP     0
+#endif
+
+#if NOR_FLASH_RAWLOG_SEGMENTS * 64 > FLASH2_SIZE_MB * 1024 / 2
+#error "NOR_FLASH_RAWLOG_SEGMENTS must leave at least half of FLASH2 to LittleFS"
+#endif
+
+/*
+ * Recording time index - set via CMakeLists.txt. Once a time source is set,
+ * handles opened for writing add a {time, offset} entry every
+ * NOR_FLASH_TIME_INDEX_KB (0 disables it). The index is a LittleFS custom
+ * attribute committed with each sync; when the entries run out, every other
+ * one is dropped and the spacing doubles.
+ */
+#ifndef NOR_FLASH_TIME_INDEX_KB
+#define NOR_FLASH_TIME_INDEX_KB       64
+#endif
+
+#ifndef NOR_FLASH_TIME_INDEX_ENTRIES
+#define NOR_FLASH_TIME_INDEX_ENTRIES  64
+#endif
+
+#if (NOR_FLASH_TIME_INDEX_ENTRIES < 2) || (16 + 8 * NOR_FLASH_TIME_INDEX_ENTRIES > 1022)
+#error "NOR_FLASH_TIME_INDEX_ENTRIES must be 2..125 to fit a LittleFS attribute"
+#endif
+
+/* Stack of the worker that brings FLASH2 up alongside FLASH1 - set via CMakeLists.txt */
+#ifndef NOR_FLASH_INIT_STACK_SIZE
+#define NOR_FLASH_INIT_STACK_SIZE 2048
+#endif
+
+/* Retained-RAM allocator snapshot to skip the first lookahead scan - set via CMakeLists.txt */
+#ifndef NOR_FLASH_MOUNT_SNAPSHOT
+#define NOR_FLASH_MOUNT_SNAPSHOT  1
+#endif
+
+/* Open modes for nor_flash_open() */
+typedef enum {
+    NOR_FLASH_MODE_READ,      /* Existing file, read-only */
+    NOR_FLASH_MODE_APPEND,    /* Create if missing, writes go to the end */
+    NOR_FLASH_MODE_WRITE,     /* Create or truncate */
+} nor_flash_mode_t;
+
+/* Persistent open-file handle (opaque) */
+typedef struct nor_flash_file nor_flash_file_t;
+
+/* Per-window callback for nor_flash_read_stream(); return non-zero to stop */
+typedef int (*nor_flash_read_cb_t)(const void *data, size_t len, uint32_t offset, void *user_data);
+
+/* Wall-clock source for time indexes, in seconds since 1970 (UTC) */
+typedef uint32_t (*nor_flash_time_fn_t)(void);
+
+/* Completion callback for nor_flash_prog_async(), runs on the worker thread */
+typedef void (*nor_flash_prog_cb_t)(flash_device_t device, int result, void *user_data);
+
+/* Operations counted by nor_flash_get_stats() (LittleFS block device callbacks) */
+enum nor_flash_op {
+    NOR_FLASH_OP_READ,
+    NOR_FLASH_OP_PROG,
+    NOR_FLASH_OP_ERASE,
+    NOR_FLASH_OP_SYNC,
+    NOR_FLASH_OP_COUNT
+};
+
+/* Latency histogram: bucket b counts operations in [2^(b-1), 2^b) us, the last is open-ended */
+#define NOR_FLASH_STATS_BUCKETS 20
+
+struct nor_flash_op_stats {
+    uint32_t count;
+    uint32_t errors;
+    uint64_t bytes;
+    uint64_t total_us;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint32_t hist[NOR_FLASH_STATS_BUCKETS];
+};
+
+struct nor_flash_stats {
+    struct nor_flash_op_stats op[NOR_FLASH_OP_COUNT];
+    uint32_t compactions;      /* LittleFS metadata compactions */
+    uint32_t relocations;      /* LittleFS block relocations (bad or worn blocks) */
+    uint32_t erases_skipped;   /* Erases already done by the pre-erase pool */
+};
+
+/* Erase-count distribution for nor_flash_get_wear() */
+#define NOR_FLASH_WEAR_BUCKETS 16
+
+struct nor_flash_wear {
+    uint32_t blocks;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t bucket_width;     /* hist[i]: blocks with i*width <= erases < (i+1)*width */
+    uint32_t hist[NOR_FLASH_WEAR_BUCKETS];
+    uint32_t lost;             /* Erases not counted because a block's RAM counter was full */
+};
+
+/* Position in the raw log, from nor_flash_rawlog_seek() */
+struct nor_flash_rawlog_pos {
+    uint32_t seg;              /* Segment index in the region */
+    uint32_t off;              /* Record offset within the segment */
+};
+
+/*
+ * Bring-up in two stages for callers that may still decide to power down.
+ * nor_flash_system_mount() initializes and mounts both devices without
+ * writing to either. nor_flash_system_start() then does the first writes:
+ * repair (or formatting a blank chip, NOR_FLASH_FORMAT_BLANK) and starting
+ * the pre-erase pool. nor_flash_system_init() runs both. All return -EIO if
+ * either device is not ready; the other one is usable regardless.
+ */
+int nor_flash_system_mount(void);
+int nor_flash_system_start(void);
 int nor_flash_system_init(void);
+
+/* Result of the device's bring-up so far (0 = ready) */
+int nor_flash_init_status(flash_device_t device);
 int nor_flash_basic_init(void);
 int nor_flash_basic_test(void);
 
@@ -85,6 +385,131 @@ int nor_flash_read_file(flash_device_t device, const char *filename, void *buffe
 int nor_flash_write_struct(flash_device_t device, const char *filename, const void *data, size_t size);
 int nor_flash_read_struct(flash_device_t device, const char *filename, void *buffer, size_t size);
 
+/*
+ * Raw asynchronous program. Queues a write of len bytes at addr (page splitting
+ * is handled by the driver) and returns immediately; -ENOMSG if the queue is
+ * full. data must stay valid until completion is reported through cb and/or
+ * signal (raised with the result). The range must lie in the device's
+ * FLASHn_RAW_KB region, or in its LittleFS range while that is not mounted;
+ * anything else (mounted LittleFS, raw log, wear table) returns -EACCES.
+ */
+int nor_flash_prog_async(flash_device_t device, uint32_t addr, const void *data, size_t len,
+                         nor_flash_prog_cb_t cb, void *user_data, struct k_poll_signal *signal);
+
+/* Block until every previously queued async program has completed */
+int nor_flash_prog_async_flush(void);
+
+/*
+ * Erase a raw range (addr and len must be 4KB aligned). Aligned spans use
+ * 64KB/32KB block erase and the full device uses chip erase. The range is
+ * held to the same regions as nor_flash_prog_async(): -EACCES for mounted
+ * LittleFS blocks, the raw log or the wear table.
+ *
+ * On FLASH1, reads arriving during an erase suspend it (FLASH1_ERASE_SUSPEND)
+ * for erases that run outside the filesystem lock: this one, the pre-erase
+ * pool and the wear table. Erases LittleFS issues from its own write path
+ * hold the lock that LittleFS reads also need, so those reads wait for the
+ * erase instead.
+ */
+int nor_flash_erase_range(flash_device_t device, uint32_t addr, size_t len);
+
+/*
+ * Reformat a device; wipe=true erases the LittleFS range first. That is a
+ * chip erase when LittleFS spans the whole device; with the wear table, a
+ * raw region or the raw log on the device it is done in 64KB/32KB blocks
+ * instead so those survive, which takes about twice as long on the MX25L.
+ * Mount never formats (unless NOR_FLASH_FORMAT_BLANK), so this is how new
+ * chips are provisioned and the only way to recreate a damaged filesystem.
+ * Also clears read-only mode.
+ */
+int nor_flash_format(flash_device_t device, bool wipe);
+
+/*
+ * Save the allocator state to retained RAM before System OFF so the next
+ * mount can skip the lookahead scan. Only restored if its generation is the
+ * one recorded by the last save and the metadata seed of the next mount
+ * matches. Returns -EBUSY with files open, -ENODATA if no
+ * scan has happened since mount. RAM retention must be enabled by the caller.
+ */
+int nor_flash_snapshot_save(flash_device_t device);
+
+/*
+ * Handle-based file access. The file stays open across calls with its own
+ * cache, so appends are buffered and only reach flash when a cache fills or
+ * on nor_flash_sync()/nor_flash_close(). Returns -ENFILE when all
+ * NOR_FLASH_MAX_OPEN_FILES handles are in use.
+ */
+int nor_flash_open(flash_device_t device, const char *filename, nor_flash_mode_t mode,
+                   nor_flash_file_t **handle);
+int nor_flash_append(nor_flash_file_t *handle, const void *data, size_t len);
+int nor_flash_sync(nor_flash_file_t *handle);
+int nor_flash_close(nor_flash_file_t *handle);
+
+/*
+ * Windowed reads with caller-provided buffers (no heap). nor_flash_read_at()
+ * returns the bytes read (0 at end of file). nor_flash_read_stream() reads
+ * the whole file through window, calling cb once per filled window; it
+ * returns 0 at end of file, the callback's non-zero value if it stopped
+ * early, or a negative error.
+ */
+int nor_flash_read_at(nor_flash_file_t *handle, uint32_t offset, void *buf, size_t len);
+int nor_flash_read_stream(flash_device_t device, const char *filename, void *window, size_t window_len,
+                          nor_flash_read_cb_t cb, void *user_data);
+
+/*
+ * Time-indexed recordings. With a time source set, writes through handles
+ * keep a sparse time index with the file. nor_flash_seek_time() looks the
+ * time up in the index of a handle opened for reading, interpolates between
+ * the two entries around it and seeks there. It returns the new offset,
+ * -EBADF for a handle not opened with NOR_FLASH_MODE_READ, -ENODATA if the
+ * file has no index, or -ERANGE outside the recorded span.
+ */
+void nor_flash_set_time_source(nor_flash_time_fn_t now);
+int nor_flash_seek_time(nor_flash_file_t *handle, const struct tm *when);
+
+/*
+ * Copy the device's counters since boot (or the last reset). The struct is
+ * plain data, so it can be kept with nor_flash_write_struct() as well.
+ */
+int nor_flash_get_stats(flash_device_t device, struct nor_flash_stats *stats);
+void nor_flash_reset_stats(flash_device_t device);
+
+/* Latency percentile (e.g. 99) from the histogram, as a bucket upper bound in us */
+uint32_t nor_flash_stats_percentile(const struct nor_flash_op_stats *op, unsigned int pct);
+
+/* Log count, bytes and min/avg/max/p99 per operation plus LittleFS events */
+void nor_flash_dump_stats(flash_device_t device);
+
+/*
+ * Erase-count histogram over every 4KB block of the device, including
+ * erases not yet written back. Reads the stored table, so it is not cheap.
+ */
+int nor_flash_get_wear(flash_device_t device, struct nor_flash_wear *wear);
+
+/* Write pending erase counts back to flash now (e.g. before System OFF) */
+int nor_flash_wear_flush(flash_device_t device);
+
+/*
+ * Raw recording log (FLASH2, NOR_FLASH_RAWLOG_SEGMENTS > 0). Appends go
+ * straight to flash as CRC-checked records tagged with the caller's
+ * timestamp (any unit, non-decreasing) and are durable once append returns.
+ * An append that crosses a segment end is stored as several records.
+ *
+ * seek() positions at the first record with time >= the given one (0 for
+ * the oldest). read() copies one record and advances pos: it returns the
+ * payload length, 0 at the end, -EMSGSIZE if buf is too small (pos is not
+ * moved), or -EBADMSG for a damaged record (pos skips it). recover() rescans
+ * the region as done at init and returns the number of damaged records.
+ */
+int nor_flash_rawlog_append(const void *data, size_t len, uint32_t time);
+int nor_flash_rawlog_seek(uint32_t time, struct nor_flash_rawlog_pos *pos);
+int nor_flash_rawlog_read(struct nor_flash_rawlog_pos *pos, void *buf, size_t len, uint32_t *time);
+int nor_flash_rawlog_recover(void);
+int nor_flash_rawlog_clear(void);
+
+/* True if the device mounted but failed repair and rejects writes */
+bool nor_flash_is_readonly(flash_device_t device);
+
 /* Get flash device info */
 const char* nor_flash_get_device_name(flash_device_t device);
 uint32_t nor_flash_get_device_size(flash_device_t device);
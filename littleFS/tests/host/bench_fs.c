@@ -0,0 +1,216 @@
+/*
+ * File system benchmark on the timed flash model: mount, small-file create,
+ * appends (against rewriting the whole file), sequential write and read,
+ * delete. Every case runs on both devices and reports virtual time through
+ * host_bench().
+ */
+
+#include "host_nor_flash.h"
+
+#define SMALL_FILES  32
+#define SMALL_SIZE   64
+#define SEQ_SIZE     (1024 * 1024)
+#define SEQ_CHUNK    4096
+#define APPENDS      400
+#define APPEND_SIZE  64
+#define SYNC_EVERY   10
+
+static uint8_t chunk[SEQ_CHUNK];
+
+static const char *dev_name(flash_device_t device)
+{
+    return (device == FLASH1) ? "flash1" : "flash2";
+}
+
+static void report(flash_device_t device, const char *what, double value, const char *unit)
+{
+    char metric[48];
+
+    snprintf(metric, sizeof(metric), "%s.%s", dev_name(device), what);
+    host_bench(metric, value, unit);
+}
+
+static double mb_per_s(size_t bytes, int64_t us)
+{
+    return (double)bytes / (double)MAX(us, 1);
+}
+
+static void write_small_files(flash_device_t device, int count)
+{
+    char name[16], data[SMALL_SIZE];
+
+    for (int i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "s%d", i);
+        memset(data, 'a' + i % 26, sizeof(data));
+        REQUIRE(nor_flash_write_file(device, name, data, sizeof(data)) == 0);
+    }
+}
+
+static void write_seq(flash_device_t device, const char *name, size_t size)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    lfs_file_t file;
+
+    REQUIRE(lfs_file_open(lfs, &file, name, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) == 0);
+    for (size_t off = 0; off < size; off += SEQ_CHUNK) {
+        memset(chunk, (uint8_t)(off / SEQ_CHUNK), sizeof(chunk));
+        REQUIRE(lfs_file_write(lfs, &file, chunk, SEQ_CHUNK) == SEQ_CHUNK);
+    }
+    REQUIRE(lfs_file_close(lfs, &file) == 0);
+}
+
+/* Power cycle and the boot's mount stage, no snapshot to restore */
+static int64_t remount(flash_device_t device)
+{
+    lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+    struct k_mutex *lock = (device == FLASH1) ? &lfs1_lock : &lfs2_lock;
+    bool *mounted = (device == FLASH1) ? &lfs1_mounted : &lfs2_mounted;
+
+    mx25l_power_cycle((device == FLASH1) ? &mx25l_flash1 : &mx25l_flash2);
+    k_mutex_lock(lock, K_FOREVER);
+    lfs_unmount(lfs);
+    memset(lfs, 0, sizeof(*lfs));
+    int64_t start = host_time_us();
+    *mounted = (lfs_init_mount(device) == 0);
+    int64_t us = host_time_us() - start;
+    k_mutex_unlock(lock);
+    REQUIRE(*mounted);
+    return us;
+}
+
+static void test_mount(void)
+{
+    host_boot_blank();
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        report(device, "mount_empty", remount(device) / 1000.0, "ms");
+        write_small_files(device, SMALL_FILES);
+        write_seq(device, "seq.bin", SEQ_SIZE);
+        report(device, "mount_populated", remount(device) / 1000.0, "ms");
+    }
+    host_check_bus();
+}
+
+static void test_create(void)
+{
+    host_boot_blank();
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        int64_t start = host_time_us();
+        write_small_files(device, SMALL_FILES);
+        report(device, "create_small", (host_time_us() - start) / (double)SMALL_FILES / 1000.0, "ms");
+    }
+    host_check_bus();
+}
+
+/* The same records the old way: the whole log rewritten for each one */
+static int64_t rewrite_log(flash_device_t device)
+{
+    static uint8_t log[APPENDS * APPEND_SIZE];
+
+    int64_t start = host_time_us();
+    for (int i = 0; i < APPENDS; i++) {
+        memset(&log[i * APPEND_SIZE], (uint8_t)i, APPEND_SIZE);
+        REQUIRE(nor_flash_write_file(device, "whole.bin", log, (i + 1) * APPEND_SIZE) == 0);
+    }
+    return host_time_us() - start;
+}
+
+/* 64-byte records through a handle, synced every SYNC_EVERY records,
+ * against rewriting the file for each */
+static void test_append(void)
+{
+    uint8_t rec[APPEND_SIZE];
+    nor_flash_file_t *h;
+
+    host_boot_blank();
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        REQUIRE(nor_flash_open(device, "log.bin", NOR_FLASH_MODE_APPEND, &h) == 0);
+        int64_t start = host_time_us();
+        for (int i = 0; i < APPENDS; i++) {
+            memset(rec, (uint8_t)i, sizeof(rec));
+            REQUIRE(nor_flash_append(h, rec, sizeof(rec)) == 0);
+            if ((i + 1) % SYNC_EVERY == 0) REQUIRE(nor_flash_sync(h) == 0);
+        }
+        int64_t us = host_time_us() - start;
+        REQUIRE(nor_flash_close(h) == 0);
+        CHECK_EQ(nor_flash_get_file_size(device, "log.bin"), APPENDS * APPEND_SIZE);
+
+        int64_t rewrite_us = rewrite_log(device);
+        CHECK_EQ(nor_flash_get_file_size(device, "whole.bin"), APPENDS * APPEND_SIZE);
+
+        report(device, "append", APPENDS * 1e6 / (double)MAX(us, 1), "appends/s");
+        report(device, "rewrite", APPENDS * 1e6 / (double)MAX(rewrite_us, 1), "appends/s");
+        report(device, "append_speedup", rewrite_us / (double)MAX(us, 1), "x");
+        CHECK(rewrite_us > 10 * us);
+    }
+    host_check_bus();
+}
+
+static void test_seq_write(void)
+{
+    host_boot_blank();
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        int64_t start = host_time_us();
+        write_seq(device, "seq.bin", SEQ_SIZE);
+        report(device, "seq_write", mb_per_s(SEQ_SIZE, host_time_us() - start), "MB/s");
+    }
+    host_check_bus();
+}
+
+static void test_seq_read(void)
+{
+    host_boot_blank();
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+        lfs_file_t file;
+
+        write_seq(device, "seq.bin", SEQ_SIZE);
+        REQUIRE(lfs_file_open(lfs, &file, "seq.bin", LFS_O_RDONLY) == 0);
+        int64_t start = host_time_us();
+        for (size_t off = 0; off < SEQ_SIZE; off += SEQ_CHUNK) {
+            REQUIRE(lfs_file_read(lfs, &file, chunk, SEQ_CHUNK) == SEQ_CHUNK);
+            CHECK_EQ(chunk[SEQ_CHUNK - 1], (uint8_t)(off / SEQ_CHUNK));
+        }
+        report(device, "seq_read", mb_per_s(SEQ_SIZE, host_time_us() - start), "MB/s");
+        REQUIRE(lfs_file_close(lfs, &file) == 0);
+    }
+    host_check_bus();
+}
+
+static void test_delete(void)
+{
+    char name[16];
+
+    host_boot_blank();
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+
+        write_small_files(device, SMALL_FILES);
+        write_seq(device, "seq.bin", SEQ_SIZE);
+
+        int64_t start = host_time_us();
+        REQUIRE(lfs_remove(lfs, "seq.bin") == 0);
+        report(device, "delete_large", (host_time_us() - start) / 1000.0, "ms");
+
+        start = host_time_us();
+        for (int i = 0; i < SMALL_FILES; i++) {
+            snprintf(name, sizeof(name), "s%d", i);
+            REQUIRE(lfs_remove(lfs, name) == 0);
+        }
+        report(device, "delete_small", (host_time_us() - start) / (double)SMALL_FILES / 1000.0, "ms");
+    }
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"mount", test_mount},
+    {"create", test_create},
+    {"append", test_append},
+    {"seq_write", test_seq_write},
+    {"seq_read", test_seq_read},
+    {"delete", test_delete},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
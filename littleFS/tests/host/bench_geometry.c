@@ -0,0 +1,101 @@
+/*
+ * LittleFS geometry on a 64MB FLASH2, one build per profile of read size,
+ * cache size, lookahead and metadata_max (see CMakeLists.txt): mount time
+ * of a populated image, small-file write and read latency, sequential
+ * write and read MB/s.
+ */
+
+#include "host_nor_flash.h"
+
+#define SMALL_FILES  64
+#define SMALL_SIZE   64
+#define SEQ_SIZE     (2 * 1024 * 1024)
+#define SEQ_CHUNK    4096
+
+static uint8_t chunk[SEQ_CHUNK];
+
+static void small_name(char *name, size_t size, int i)
+{
+    snprintf(name, size, "cfg%d.bin", i);
+}
+
+/* Power cycle and the boot's mount stage */
+static int64_t remount(void)
+{
+    mx25l_power_cycle(&mx25l_flash2);
+    k_mutex_lock(&lfs2_lock, K_FOREVER);
+    lfs_unmount(&lfs2);
+    memset(&lfs2, 0, sizeof(lfs2));
+    int64_t start = host_time_us();
+    lfs2_mounted = (lfs_init_mount(FLASH2) == 0);
+    int64_t us = host_time_us() - start;
+    k_mutex_unlock(&lfs2_lock);
+    REQUIRE(lfs2_mounted);
+    return us;
+}
+
+static int64_t write_seq(void)
+{
+    lfs_file_t file;
+
+    int64_t start = host_time_us();
+    REQUIRE(lfs_file_open(&lfs2, &file, "seq.bin", LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) == 0);
+    for (size_t off = 0; off < SEQ_SIZE; off += SEQ_CHUNK) {
+        memset(chunk, (uint8_t)(off / SEQ_CHUNK), sizeof(chunk));
+        REQUIRE(lfs_file_write(&lfs2, &file, chunk, SEQ_CHUNK) == SEQ_CHUNK);
+    }
+    REQUIRE(lfs_file_close(&lfs2, &file) == 0);
+    return host_time_us() - start;
+}
+
+static int64_t read_seq(void)
+{
+    lfs_file_t file;
+
+    int64_t start = host_time_us();
+    REQUIRE(lfs_file_open(&lfs2, &file, "seq.bin", LFS_O_RDONLY) == 0);
+    for (size_t off = 0; off < SEQ_SIZE; off += SEQ_CHUNK) {
+        REQUIRE(lfs_file_read(&lfs2, &file, chunk, SEQ_CHUNK) == SEQ_CHUNK);
+        CHECK_EQ(chunk[SEQ_CHUNK - 1], (uint8_t)(off / SEQ_CHUNK));
+    }
+    REQUIRE(lfs_file_close(&lfs2, &file) == 0);
+    return host_time_us() - start;
+}
+
+static void test_sweep(void)
+{
+    char name[16], data[SMALL_SIZE];
+
+    host_boot_blank();
+    host_bench("lookahead", FLASH2_LFS_LOOKAHEAD_SIZE * 8, "blocks");
+
+    int64_t start = host_time_us();
+    for (int i = 0; i < SMALL_FILES; i++) {
+        small_name(name, sizeof(name), i);
+        memset(data, 'a' + i % 26, sizeof(data));
+        REQUIRE(nor_flash_write_file(FLASH2, name, data, sizeof(data)) == 0);
+    }
+    host_bench("small_write", (host_time_us() - start) / (double)SMALL_FILES / 1000.0, "ms");
+    host_bench("seq_write", (double)SEQ_SIZE / write_seq(), "MB/s");
+
+    host_bench("mount", remount() / 1000.0, "ms");
+
+    start = host_time_us();
+    for (int i = 0; i < SMALL_FILES; i++) {
+        small_name(name, sizeof(name), i);
+        REQUIRE(nor_flash_read_file(FLASH2, name, data, sizeof(data)) == SMALL_SIZE);
+        CHECK_EQ(data[SMALL_SIZE - 1], 'a' + i % 26);
+    }
+    host_bench("small_read", (host_time_us() - start) / (double)SMALL_FILES / 1000.0, "ms");
+    host_bench("seq_read", (double)SEQ_SIZE / read_seq(), "MB/s");
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"sweep", test_sweep},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
@@ -0,0 +1,94 @@
+/*
+ * Bring-up of both devices, init and mount, with an artificial delay in
+ * each one's init (timing.ready_delay_us): one device after the other on
+ * the calling thread, then as nor_flash_system_mount() runs them, FLASH2
+ * on a worker alongside FLASH1. The chips sit on separate buses, so the
+ * parallel bring-up takes as long as the slower device.
+ */
+
+#include "host_nor_flash.h"
+
+#define SLACK_US  1000      /* Thread switches and the join */
+
+static const struct {
+    uint32_t flash1_ms, flash2_ms;
+} delays[] = {
+    {0, 0},
+    {100, 0},
+    {0, 100},
+    {100, 100},
+    {50, 200},
+};
+
+/* Power off and on: nothing initialized or mounted */
+static void power_cycle(uint32_t flash1_ms, uint32_t flash2_ms)
+{
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        lfs_t *lfs = (device == FLASH1) ? &lfs1 : &lfs2;
+        bool *mounted = (device == FLASH1) ? &lfs1_mounted : &lfs2_mounted;
+
+        if (*mounted) lfs_unmount(lfs);
+        memset(lfs, 0, sizeof(*lfs));
+        *mounted = false;
+    }
+    flash1.initialized = false;
+    flash2_initialized = false;
+    flash1_init_status = flash2_init_status = -EAGAIN;
+    mx25l_power_cycle(&mx25l_flash1);
+    mx25l_power_cycle(&mx25l_flash2);
+    mx25l_flash1.timing.ready_delay_us = flash1_ms * 1000;
+    mx25l_flash2.timing.ready_delay_us = flash2_ms * 1000;
+}
+
+static void report(int i, const char *what, double value, const char *unit)
+{
+    char metric[64];
+
+    snprintf(metric, sizeof(metric), "d%u_%u.%s", delays[i].flash1_ms, delays[i].flash2_ms, what);
+    host_bench(metric, value, unit);
+}
+
+static void test_parallel(void)
+{
+    host_boot_blank();
+    REQUIRE(nor_flash_write_file(FLASH1, "a.txt", "flash1", 6) == 0);
+    REQUIRE(nor_flash_write_file(FLASH2, "b.txt", "flash2", 6) == 0);
+
+    for (size_t i = 0; i < ARRAY_SIZE(delays); i++) {
+        power_cycle(delays[i].flash1_ms, delays[i].flash2_ms);
+        int64_t start = host_time_us();
+        REQUIRE(device_bringup(FLASH1) == 0);
+        int64_t flash1_us = host_time_us() - start;
+        start = host_time_us();
+        REQUIRE(device_bringup(FLASH2) == 0);
+        int64_t flash2_us = host_time_us() - start;
+
+        power_cycle(delays[i].flash1_ms, delays[i].flash2_ms);
+        start = host_time_us();
+        REQUIRE(nor_flash_system_mount() == 0);
+        int64_t parallel_us = host_time_us() - start;
+        CHECK_EQ(nor_flash_init_status(FLASH1), 0);
+        CHECK_EQ(nor_flash_init_status(FLASH2), 0);
+
+        report(i, "flash1", flash1_us / 1000.0, "ms");
+        report(i, "flash2", flash2_us / 1000.0, "ms");
+        report(i, "serial", (flash1_us + flash2_us) / 1000.0, "ms");
+        report(i, "parallel", parallel_us / 1000.0, "ms");
+        report(i, "speedup", (flash1_us + flash2_us) / (double)parallel_us, "x");
+        CHECK(parallel_us <= MAX(flash1_us, flash2_us) + SLACK_US);
+
+        char buf[8];
+        CHECK_EQ(nor_flash_read_file(FLASH1, "a.txt", buf, sizeof(buf)), 6);
+        CHECK_EQ(nor_flash_read_file(FLASH2, "b.txt", buf, sizeof(buf)), 6);
+    }
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"parallel", test_parallel},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
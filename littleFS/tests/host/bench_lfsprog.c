@@ -0,0 +1,126 @@
+/*
+ * Host CPU cost of lfs1_prog() with the SPI bus stubbed out, so what is
+ * timed is the driver's own work: WREN, the page program and one status
+ * poll that finds the chip ready. The same page program staged through a
+ * stack buffer, as the driver used to send it, is timed alongside. The
+ * stub counts the payload bytes that did not go out from the caller's
+ * buffer: none for the driver, the whole page for the staged copy. On the
+ * host a 256-byte memcpy is a few ns, inside the run-to-run spread, so the
+ * count is what is checked.
+ */
+
+#include <time.h>
+
+#include "host_nor_flash.h"
+
+#define CALLS   200000
+#define RUNS    5
+
+static uint8_t page[FLASH_PAGE_SIZE];
+static const void *payload;     /* Data buffer of the last page program */
+static uint64_t staged_bytes;   /* Page program payload not sent from the caller's buffer */
+
+/* Every transfer completes at once, with the chip reading back ready */
+static int spi_stub(const struct spi_buf_set *tx, const struct spi_buf_set *rx)
+{
+    const uint8_t *op = tx->buffers[0].buf;
+
+    for (size_t i = 0; rx && i < rx->count; i++) {
+        if (rx->buffers[i].buf) memset(rx->buffers[i].buf, 0, rx->buffers[i].len);
+    }
+    if (op[0] == CMD_PAGE_PROGRAM || op[0] == CMD_PAGE_PROGRAM_4B) {
+        bool split = tx->count == 2 && tx->buffers[1].len > 0;
+        payload = split ? tx->buffers[1].buf : NULL;
+        if (!split || payload != page) staged_bytes += FLASH_PAGE_SIZE;
+    }
+    return 1;
+}
+
+/* The page program as it was: header and payload copied into one buffer */
+static int staged_prog_page(uint32_t addr, const uint8_t *data, size_t write_size)
+{
+    uint8_t cmd[5 + FLASH_PAGE_SIZE];
+    size_t hdr_len = flash1_cmd_addr(cmd, CMD_PAGE_PROGRAM, CMD_PAGE_PROGRAM_4B, addr);
+    int ret = -EIO;
+
+    memcpy(&cmd[hdr_len], data, write_size);
+    flash1_lock_write();
+    if (flash1_write_enable() == 0 &&
+        flash1_write_cmd(cmd, hdr_len + write_size, NULL, 0) == 0 &&
+        flash1_wait_ready(FLASH1_WAIT_PROGRAM) == 0) {
+        ret = 0;
+    }
+    k_mutex_unlock(&flash1.lock);
+    return ret;
+}
+
+static int64_t cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int lfs_prog_call(uint32_t i)
+{
+    return lfs1_prog(&lfs_cfg1, i % FLASH1_LFS_BLOCKS, 0, page, FLASH_PAGE_SIZE);
+}
+
+static int prog_page_call(uint32_t i)
+{
+    return flash1_prog_page((i % FLASH1_LFS_BLOCKS) * FLASH_SECTOR_SIZE, page, FLASH_PAGE_SIZE);
+}
+
+static int staged_call(uint32_t i)
+{
+    return staged_prog_page((i % FLASH1_LFS_BLOCKS) * FLASH_SECTOR_SIZE, page, FLASH_PAGE_SIZE);
+}
+
+/* Best of RUNS, per call, and the payload bytes copied on the way */
+static void measure(const char *name, int (*call)(uint32_t))
+{
+    int64_t best = INT64_MAX;
+    char metric[48];
+
+    staged_bytes = 0;
+    for (int r = 0; r < RUNS; r++) {
+        int64_t start = cpu_ns();
+        for (uint32_t i = 0; i < CALLS; i++) {
+            REQUIRE(call(i) == 0);
+        }
+        best = MIN(best, cpu_ns() - start);
+    }
+    snprintf(metric, sizeof(metric), "%s.cpu", name);
+    host_bench(metric, best / (double)CALLS, "ns");
+    snprintf(metric, sizeof(metric), "%s.copied", name);
+    host_bench(metric, staged_bytes / ((double)CALLS * RUNS), "bytes");
+}
+
+static void test_cpu(void)
+{
+    host_boot_blank();
+    memset(page, 0x5A, sizeof(page));
+    host_spi_hook = spi_stub;
+
+    /* The driver sends the payload from where LittleFS has it */
+    REQUIRE(lfs_prog_call(0) == 0);
+    CHECK(payload == page);
+
+    measure("lfs1_prog_256", lfs_prog_call);
+    CHECK_EQ(staged_bytes, 0);
+    measure("prog_page_256", prog_page_call);
+    CHECK_EQ(staged_bytes, 0);
+    measure("staged_256", staged_call);
+    CHECK_EQ(staged_bytes, (uint64_t)FLASH_PAGE_SIZE * CALLS * RUNS);
+    host_spi_hook = NULL;
+}
+
+static const struct host_test tests[] = {
+    {"cpu", test_cpu},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
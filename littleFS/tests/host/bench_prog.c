@@ -0,0 +1,72 @@
+/*
+ * FLASH1 page-program throughput against the timing model. The floor for
+ * one page is WREN, the page on the bus, tPP and the status read that sees
+ * it done; the ready wait's polling is what comes on top. Built once with
+ * the default wait profile and once sleeping 1ms between polls, as the
+ * driver used to.
+ */
+
+/* Before nor_flash.c fills in the default */
+#ifdef FLASH1_WAIT_PROFILE_PROGRAM
+#define DEFAULT_PROFILE 0
+#else
+#define DEFAULT_PROFILE 1
+#endif
+
+#include "host_nor_flash.h"
+
+#define RAW_BASE   (FLASH1_LFS_BLOCKS * FLASH_SECTOR_SIZE)
+#define SIZE       (FLASH1_RAW_KB * 1024)
+#define CHUNK      4096
+
+static uint8_t data[CHUNK];
+
+static int64_t time_of(int ret, int64_t start)
+{
+    REQUIRE(ret == 0);
+    return host_time_us() - start;
+}
+
+static void test_page_program(void)
+{
+    uint8_t status;
+    int64_t t;
+
+    host_boot_blank();
+    REQUIRE(flash1_erase_range(RAW_BASE, SIZE) == 0);
+
+    /* The floor, from the bus cost of each part */
+    t = host_time_us();
+    int64_t wren = time_of(flash1_write_enable(), t);
+    t = host_time_us();
+    int64_t poll = time_of(flash1_read_status(&status), t);
+    t = host_time_us();
+    int64_t page = time_of(flash1_read_data(0, data, FLASH_PAGE_SIZE), t);
+    double floor_us = wren + page + mx25l_flash1.timing.pp_us + poll;
+
+    int64_t start = host_time_us();
+    for (uint32_t off = 0; off < SIZE; off += CHUNK) {
+        memset(data, (uint8_t)(off / CHUNK), sizeof(data));
+        REQUIRE(flash1_prog_data(RAW_BASE + off, data, CHUNK) == 0);
+    }
+    int64_t us = host_time_us() - start;
+    CHECK(memcmp(&mx25l_flash1.mem[RAW_BASE + SIZE - CHUNK], data, CHUNK) == 0);
+
+    double page_us = us / (double)(SIZE / FLASH_PAGE_SIZE);
+    host_bench("page_floor", floor_us, "us");
+    host_bench("page", page_us, "us");
+    host_bench("model_limit", FLASH_PAGE_SIZE / floor_us, "MB/s");
+    host_bench("throughput", (double)SIZE / us, "MB/s");
+    host_bench("efficiency", 100.0 * floor_us / page_us, "%");
+    if (DEFAULT_PROFILE) CHECK(floor_us / page_us > 0.9);
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"page_program", test_page_program},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
@@ -0,0 +1,136 @@
+/*
+ * Sustained recording on FLASH2: 2MB in 8KB records appended to the raw
+ * log, against the same data written to a LittleFS file with
+ * lfs_file_write(). Once with each paying for its erases as it goes, once
+ * with the pre-erase thread's work done between records, off the clock, as
+ * when recording leaves it idle time. The page programs alone set the
+ * ceiling, reported alongside; erased ahead, the raw log must reach 80% of
+ * it.
+ */
+
+#include "host_nor_flash.h"
+
+#define SIZE         (2 * 1024 * 1024)
+#define RECORD_SIZE  8192
+#define RECORDS      (SIZE / RECORD_SIZE)
+
+/* 2MB and the segment and record headers, without wrapping */
+#if NOR_FLASH_RAWLOG_SEGMENTS < 40
+#error "Records 2MB into the raw log: needs NOR_FLASH_RAWLOG_SEGMENTS >= 40"
+#endif
+
+static uint8_t record[RECORD_SIZE];
+
+static void fill(uint32_t r)
+{
+    memset(record, (uint8_t)(r * 7 + 1), sizeof(record));
+}
+
+/* Every piece of every record, in order; records split at segment ends */
+static void check_rawlog(void)
+{
+    struct nor_flash_rawlog_pos pos;
+    uint32_t time, total = 0, wrong = 0;
+    int n;
+
+    REQUIRE(nor_flash_rawlog_seek(0, &pos) == 0);
+    while ((n = nor_flash_rawlog_read(&pos, record, sizeof(record), &time)) > 0) {
+        for (int i = 0; i < n; i++) wrong += (record[i] != (uint8_t)(time * 7 + 1));
+        total += n;
+    }
+    CHECK_EQ(n, 0);
+    CHECK_EQ(total, SIZE);
+    CHECK_EQ(wrong, 0);
+}
+
+/* Background erase keeping up: the pre-erase thread's work, off the clock */
+static void preerase(bool rawlog_side)
+{
+    if (rawlog_side) {
+        while (rawlog_preerase_step()) {}
+    } else {
+        while (preerase_step(FLASH2)) {}
+    }
+}
+
+/* Time spent in the appends alone */
+static int64_t write_rawlog(bool erased_ahead)
+{
+    int64_t us = 0;
+
+    for (uint32_t r = 0; r < RECORDS; r++) {
+        fill(r);
+        if (erased_ahead) preerase(true);
+        int64_t start = host_time_us();
+        REQUIRE(nor_flash_rawlog_append(record, sizeof(record), r) == 0);
+        us += host_time_us() - start;
+    }
+    check_rawlog();
+    return us;
+}
+
+static int64_t write_file(bool erased_ahead)
+{
+    lfs_file_t file;
+    int64_t us = 0;
+
+    int64_t start = host_time_us();
+    REQUIRE(lfs_file_open(&lfs2, &file, "rec.bin", LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC) == 0);
+    for (uint32_t r = 0; r < RECORDS; r++) {
+        fill(r);
+        if (erased_ahead) {
+            us += host_time_us() - start;
+            preerase(false);
+            start = host_time_us();
+        }
+        REQUIRE(lfs_file_write(&lfs2, &file, record, sizeof(record)) == RECORD_SIZE);
+    }
+    REQUIRE(lfs_file_close(&lfs2, &file) == 0);
+    us += host_time_us() - start;
+    CHECK_EQ(nor_flash_get_file_size(FLASH2, "rec.bin"), SIZE);
+    REQUIRE(lfs_remove(&lfs2, "rec.bin") == 0);
+    return us;
+}
+
+static void report(const char *what, int64_t raw_us, int64_t lfs_us)
+{
+    char metric[48];
+
+    snprintf(metric, sizeof(metric), "%s.rawlog", what);
+    host_bench(metric, (double)SIZE / raw_us, "MB/s");
+    snprintf(metric, sizeof(metric), "%s.lfs_file_write", what);
+    host_bench(metric, (double)SIZE / lfs_us, "MB/s");
+    snprintf(metric, sizeof(metric), "%s.speedup", what);
+    host_bench(metric, lfs_us / (double)raw_us, "x");
+    CHECK(raw_us <= lfs_us);
+}
+
+static void test_sustained(void)
+{
+    host_boot_blank();
+
+    int64_t raw_us = write_rawlog(false);
+    int64_t lfs_us = write_file(false);
+    report("inline_erase", raw_us, lfs_us);
+
+    REQUIRE(nor_flash_rawlog_clear() == 0);
+    raw_us = write_rawlog(true);
+    lfs_us = write_file(true);
+    report("erased_ahead", raw_us, lfs_us);
+
+    /* tPP only; each page's transfer comes on top */
+    double program_us = (double)SIZE / FLASH_PAGE_SIZE * mx25l_flash2.timing.pp_us;
+    host_bench("program_only", SIZE / program_us, "MB/s");
+    host_bench("efficiency", 100.0 * program_us / raw_us, "%");
+    CHECK(program_us / raw_us > 0.8);
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"sustained", test_sustained},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
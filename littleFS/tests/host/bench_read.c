@@ -0,0 +1,81 @@
+/*
+ * FLASH1 sequential read throughput for 4KB, 64KB and 1MB reads: raw from
+ * the chip, and from a file through LittleFS, whose reads of a cache size
+ * or more go straight to lfs1_read(). Each read is one transaction, so the
+ * large ones run close to the SPI clock.
+ */
+
+#include "host_nor_flash.h"
+
+#define SPAN       (2 * 1024 * 1024)
+#define FILE_SIZE  (1024 * 1024)
+
+static uint8_t buf[1024 * 1024];
+static const size_t sizes[] = {4096, 65536, 1024 * 1024};
+
+static double mb_per_s(size_t bytes, int64_t us)
+{
+    return (double)bytes / (double)MAX(us, 1);
+}
+
+static void report(const char *what, size_t size, double value)
+{
+    char metric[48];
+
+    snprintf(metric, sizeof(metric), "%s_%zuk", what, size / 1024);
+    host_bench(metric, value, "MB/s");
+}
+
+static void test_raw(void)
+{
+    host_boot_blank();
+    double bus = flash1.spi_cfg.frequency / 8e6;
+    host_bench("bus", bus, "MB/s");
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+        int64_t start = host_time_us();
+        for (uint32_t addr = 0; addr < SPAN; addr += sizes[i]) {
+            REQUIRE(flash1_read_data(addr, buf, sizes[i]) == 0);
+        }
+        double rate = mb_per_s(SPAN, host_time_us() - start);
+        report("raw", sizes[i], rate);
+        CHECK(memcmp(buf, &mx25l_flash1.mem[SPAN - sizes[i]], sizes[i]) == 0);
+        if (sizes[i] >= 65536) CHECK(rate > 0.95 * bus);
+    }
+    host_check_bus();
+}
+
+static void test_file(void)
+{
+    lfs_file_t file;
+
+    host_boot_blank();
+    for (size_t i = 0; i < FILE_SIZE; i++) {
+        buf[i] = (uint8_t)(i * 31 + i / 4096);
+    }
+    REQUIRE(nor_flash_write_file(FLASH1, "rec.bin", buf, FILE_SIZE) == 0);
+
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++) {
+        REQUIRE(lfs_file_open(&lfs1, &file, "rec.bin", LFS_O_RDONLY) == 0);
+        memset(buf, 0, FILE_SIZE);
+        int64_t start = host_time_us();
+        for (size_t off = 0; off < FILE_SIZE; off += sizes[i]) {
+            REQUIRE(lfs_file_read(&lfs1, &file, &buf[off], sizes[i]) == (lfs_ssize_t)sizes[i]);
+        }
+        report("file", sizes[i], mb_per_s(FILE_SIZE, host_time_us() - start));
+        REQUIRE(lfs_file_close(&lfs1, &file) == 0);
+        for (size_t j = 0; j < FILE_SIZE; j += 4093) {
+            CHECK_EQ(buf[j], (uint8_t)(j * 31 + j / 4096));
+        }
+    }
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"raw", test_raw},
+    {"file", test_file},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
@@ -0,0 +1,77 @@
+/*
+ * FLASH1 per-operation latency on the timed model: each driver operation
+ * on its own, with the number of chip-select assertions it takes. Every
+ * command is one transaction, so a status poll costs one transfer setup
+ * and its two bytes on the bus.
+ */
+
+#include "host_nor_flash.h"
+
+#define ROUNDS    64
+#define RAW_BASE  (FLASH1_LFS_BLOCKS * FLASH_SECTOR_SIZE)
+
+#if FLASH1_RAW_KB < 4 * ROUNDS
+#error "Programs and erases the raw region: needs FLASH1_RAW_KB >= 256"
+#endif
+
+static uint32_t transactions;
+static uint8_t buf[FLASH_PAGE_SIZE];
+
+static void count_cmd(struct mx25l *m, uint8_t op, uint32_t addr, size_t addr_len)
+{
+    transactions++;
+}
+
+/* Mean latency and transactions of ROUNDS calls of op(i) */
+#define MEASURE(name, op)                                                               \
+    do {                                                                                \
+        transactions = 0;                                                               \
+        int64_t start = host_time_us();                                                 \
+        for (uint32_t i = 0; i < ROUNDS; i++) {                                         \
+            REQUIRE((op) == 0);                                                         \
+        }                                                                               \
+        host_bench(name ".latency", (host_time_us() - start) / (double)ROUNDS, "us");   \
+        host_bench(name ".transactions", transactions / (double)ROUNDS, "count");       \
+    } while (0)
+
+static int read_status(void)
+{
+    uint8_t status;
+    return flash1_read_status(&status);
+}
+
+static int read_id(void)
+{
+    uint8_t id[3];
+    return flash1_read_id(id);
+}
+
+static void test_latency(void)
+{
+    host_boot_blank();
+    memset(buf, 0xA5, sizeof(buf));
+    mx25l_flash1.on_cmd = count_cmd;
+
+    MEASURE("read_status", read_status());
+    MEASURE("read_id", read_id());
+    MEASURE("read_16", flash1_read_data(i * 16, buf, 16));
+    MEASURE("read_256", flash1_read_data(i * FLASH_PAGE_SIZE, buf, FLASH_PAGE_SIZE));
+    MEASURE("erase_4k", flash1_erase_sector(RAW_BASE + i * FLASH_SECTOR_SIZE));
+    MEASURE("prog_16", flash1_prog_data(RAW_BASE + i * FLASH_PAGE_SIZE, buf, 16));
+    MEASURE("prog_256", flash1_prog_data(RAW_BASE + (ROUNDS + i) * FLASH_PAGE_SIZE, buf, FLASH_PAGE_SIZE));
+
+    /* Reads are one command each, whatever the length */
+    transactions = 0;
+    REQUIRE(flash1_read_data(0, buf, sizeof(buf)) == 0);
+    CHECK_EQ(transactions, 1);
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"latency", test_latency},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
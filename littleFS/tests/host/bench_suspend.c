@@ -0,0 +1,114 @@
+/*
+ * Read latency with erases running in the background: a thread erases raw
+ * region sectors back to back while reads come in at random times. With
+ * erase suspend a read waits for the suspend and its own transfer, not for
+ * the erase; the latencies are reported as percentiles and a histogram.
+ */
+
+#include "host_nor_flash.h"
+
+#define READS        2000
+#define READ_SIZE    256
+#define GAP_MIN_US   100
+#define GAP_MAX_US   2000
+#define RAW_BASE     (FLASH1_LFS_BLOCKS * FLASH_SECTOR_SIZE)
+#define RAW_SECTORS  (FLASH1_RAW_BLOCKS)
+
+/* A read that comes just after a resume waits out tERS, then the poll, B0,
+ * tESL and RDSCUR, then clocks 261 bytes at 8MHz: about 420us */
+#define P99_BOUND_US 500
+
+#if FLASH1_RAW_KB == 0
+#error "Erases the raw region: needs FLASH1_RAW_KB"
+#endif
+
+static struct k_thread eraser_thread;
+static K_THREAD_STACK_DEFINE(eraser_stack, 2048);
+static volatile bool stop;
+static uint32_t erased_sectors;
+static int64_t latency[READS];
+
+static void eraser(void *p1, void *p2, void *p3)
+{
+    for (uint32_t i = 0; !stop; i++) {
+        REQUIRE(nor_flash_erase_range(FLASH1, RAW_BASE + (i % RAW_SECTORS) * FLASH_SECTOR_SIZE,
+                                      FLASH_SECTOR_SIZE) == 0);
+        erased_sectors++;
+    }
+}
+
+static int cmp_i64(const void *a, const void *b)
+{
+    int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Power-of-two buckets from 64us up */
+static void print_histogram(void)
+{
+    uint32_t buckets[16] = {0};
+
+    for (int i = 0; i < READS; i++) {
+        int b = 0;
+        while (b < 15 && latency[i] >= (64 << b)) b++;
+        buckets[b]++;
+    }
+    for (int b = 0; b < 16; b++) {
+        if (buckets[b] == 0) continue;
+        printf("  < %6d us: %5u\n", 64 << b, buckets[b]);
+    }
+}
+
+static void test_read_latency(void)
+{
+    static uint8_t buf[READ_SIZE];
+    uint32_t seed = 12345;
+
+    host_boot_blank();
+    int64_t begin = host_time_us();
+    k_thread_create(&eraser_thread, eraser_stack, K_THREAD_STACK_SIZEOF(eraser_stack),
+                    eraser, NULL, NULL, NULL, K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+
+    for (int i = 0; i < READS; i++) {
+        seed = seed * 1103515245 + 12345;
+        k_usleep(GAP_MIN_US + (seed >> 8) % (GAP_MAX_US - GAP_MIN_US));
+
+        /* Anywhere in the LittleFS range, which the erases never touch */
+        uint32_t addr = (seed >> 4) % (RAW_BASE - READ_SIZE);
+        int64_t start = host_time_us();
+        REQUIRE(flash1_read_data(addr, buf, sizeof(buf)) == 0);
+        latency[i] = host_time_us() - start;
+        CHECK(memcmp(buf, &mx25l_flash1.mem[addr], sizeof(buf)) == 0);
+    }
+    stop = true;
+    REQUIRE(k_thread_join(&eraser_thread, K_FOREVER) == 0);
+
+    qsort(latency, READS, sizeof(latency[0]), cmp_i64);
+    int64_t p50 = latency[READS / 2], p99 = latency[READS * 99 / 100], max = latency[READS - 1];
+    host_bench("read_p50", p50, "us");
+    host_bench("read_p99", p99, "us");
+    host_bench("read_max", max, "us");
+    host_bench("suspends", mx25l_flash1.suspends, "count");
+    print_histogram();
+
+    /* The erases did run throughout */
+    CHECK(erased_sectors * (int64_t)mx25l_flash1.timing.se_us > (host_time_us() - begin) / 2);
+    if (FLASH1_ERASE_SUSPEND) {
+        CHECK(p99 <= P99_BOUND_US);
+        CHECK(mx25l_flash1.suspends > 0);
+    } else {
+        /* Reads queue behind the erase in progress */
+        CHECK(p99 > mx25l_flash1.timing.se_us / 2);
+        CHECK_EQ(mx25l_flash1.suspends, 0);
+    }
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"read_latency", test_read_latency},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
@@ -0,0 +1,141 @@
+/*
+ * Three threads at once on the thread-safe API: one reading a file off
+ * FLASH1, one appending records to a log on FLASH2, one stat'ing files on
+ * both. The same work run one job after another gives the serial time;
+ * with a lock per device the FLASH1 and FLASH2 jobs overlap, so the
+ * threads must finish in well under that. Every byte read and written is
+ * checked.
+ */
+
+#include "host_nor_flash.h"
+
+#define FILE_SIZE    (64 * 1024)
+#define READS        32
+#define RECORD_SIZE  4096
+#define RECORDS      64
+#define STATS        200
+
+static uint8_t file_data[FILE_SIZE];
+static uint64_t moved;              /* Bytes read and written by the jobs */
+
+static struct k_thread threads[3];
+static K_THREAD_STACK_DEFINE(stack0, 4096);
+static K_THREAD_STACK_DEFINE(stack1, 4096);
+static K_THREAD_STACK_DEFINE(stack2, 4096);
+static char *const stacks[] = {stack0, stack1, stack2};
+
+static uint8_t pattern(uint32_t round, uint32_t i)
+{
+    return (uint8_t)(round * 7 + i * 13 + i / 251);
+}
+
+/* FLASH1: the whole file, READS times over */
+static void reader(void *p1, void *p2, void *p3)
+{
+    static uint8_t buf[FILE_SIZE];
+
+    for (int r = 0; r < READS; r++) {
+        memset(buf, 0, sizeof(buf));
+        REQUIRE(nor_flash_read_file(FLASH1, "rec.bin", buf, sizeof(buf)) == FILE_SIZE);
+        CHECK(memcmp(buf, file_data, sizeof(buf)) == 0);
+        moved += FILE_SIZE;
+    }
+}
+
+/* FLASH2: a log of numbered records, synced after each */
+static void logger(void *p1, void *p2, void *p3)
+{
+    static uint8_t record[RECORD_SIZE];
+    nor_flash_file_t *h;
+
+    REQUIRE(nor_flash_open(FLASH2, "log.bin", NOR_FLASH_MODE_WRITE, &h) == 0);
+    for (uint32_t r = 0; r < RECORDS; r++) {
+        for (uint32_t i = 0; i < RECORD_SIZE; i++) record[i] = pattern(r, i);
+        REQUIRE(nor_flash_append(h, record, sizeof(record)) == 0);
+        REQUIRE(nor_flash_sync(h) == 0);
+        moved += RECORD_SIZE;
+    }
+    REQUIRE(nor_flash_close(h) == 0);
+}
+
+/* Both devices in turn; the log's size only ever grows */
+static void stat_files(void *p1, void *p2, void *p3)
+{
+    int last = 0;
+
+    for (int i = 0; i < STATS; i++) {
+        CHECK_EQ(nor_flash_get_file_size(FLASH1, "rec.bin"), FILE_SIZE);
+        int size = nor_flash_get_file_size(FLASH2, "log.bin");
+        if (size == -ENOENT) continue;
+        CHECK(size >= last && size % RECORD_SIZE == 0);
+        last = MAX(size, last);
+    }
+}
+
+static void (*const jobs[])(void *, void *, void *) = {reader, logger, stat_files};
+static const char *const job_names[] = {"reader", "logger", "stat"};
+
+static void check_log(void)
+{
+    static uint8_t buf[RECORD_SIZE * RECORDS];
+
+    REQUIRE(nor_flash_read_file(FLASH2, "log.bin", buf, sizeof(buf)) == (int)sizeof(buf));
+    uint32_t wrong = 0;
+    for (uint32_t r = 0; r < RECORDS; r++) {
+        for (uint32_t i = 0; i < RECORD_SIZE; i++) {
+            wrong += (buf[r * RECORD_SIZE + i] != pattern(r, i));
+        }
+    }
+    CHECK_EQ(wrong, 0);
+}
+
+static void test_stress(void)
+{
+    int64_t serial = 0;
+
+    host_boot_blank();
+    for (uint32_t i = 0; i < FILE_SIZE; i++) file_data[i] = pattern(99, i);
+    REQUIRE(nor_flash_write_file(FLASH1, "rec.bin", file_data, FILE_SIZE) == 0);
+
+    /* One job after another */
+    for (size_t j = 0; j < ARRAY_SIZE(jobs); j++) {
+        int64_t start = host_time_us();
+        jobs[j](NULL, NULL, NULL);
+        int64_t us = host_time_us() - start;
+        host_bench(job_names[j], us / 1000.0, "ms");
+        serial += us;
+    }
+    check_log();
+    uint64_t bytes = moved;
+
+    /* All at once, at one priority, the log started afresh */
+    REQUIRE(lfs_remove(&lfs2, "log.bin") == 0);
+    moved = 0;
+    int64_t start = host_time_us();
+    for (size_t j = 0; j < ARRAY_SIZE(jobs); j++) {
+        k_thread_create(&threads[j], stacks[j], K_THREAD_STACK_SIZEOF(stack0),
+                        jobs[j], NULL, NULL, NULL, K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+    }
+    for (size_t j = 0; j < ARRAY_SIZE(jobs); j++) {
+        REQUIRE(k_thread_join(&threads[j], K_FOREVER) == 0);
+    }
+    int64_t parallel = host_time_us() - start;
+    CHECK_EQ(moved, bytes);
+    check_log();
+
+    host_bench("serial", serial / 1000.0, "ms");
+    host_bench("parallel", parallel / 1000.0, "ms");
+    host_bench("serial_throughput", (double)bytes / serial, "MB/s");
+    host_bench("parallel_throughput", (double)bytes / parallel, "MB/s");
+    CHECK(parallel < serial * 3 / 4);
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"stress", test_stress},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
@@ -0,0 +1,238 @@
+/*
+ * Years of recording on FLASH2: the raw log rotating through its ring all
+ * day, a config file and an event log written through LittleFS once a day,
+ * and power cuts at random points, inside raw log appends and inside wear
+ * table write-backs alike.
+ *
+ * The model counts every erase a sector really goes through. After each
+ * cut the stored table must be short of that by exactly what was lost with
+ * RAM: the counts pending at the cut, plus the erase of the copy being
+ * written if the cut hit a write-back. More would mean pending counts were
+ * dropped before their copy was committed; less, counts stored twice.
+ */
+
+#include "host_nor_flash.h"
+
+#define BLOCKS        FLASH2_BLOCKS
+#define YEARS         3
+#define DAYS          (YEARS * 365)
+#define RECORD_SIZE   8192
+#define RECORDS       64            /* Per day: 512KB */
+#define CUT_EVERY     8             /* Days between cuts, on average */
+#define FLUSH_CUT_ONE_IN 4          /* Write-backs cut on purpose */
+
+static uint16_t table[BLOCKS];
+static uint32_t lost[BLOCKS];       /* Erases the stored table can no longer get */
+static uint8_t record[RECORD_SIZE];
+static uint32_t seed = 2024;
+
+/* State at the last power cut */
+static struct {
+    uint8_t pending[sizeof(wear2_pending)];
+    uint32_t saturated;
+    bool in_flush;
+    bool in_header;
+    int next;
+    uint32_t seq;
+} cut;
+static uint32_t cuts, flush_cuts;
+
+static uint32_t rnd(uint32_t n)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % n;
+}
+
+static uint8_t pending_of(const uint8_t *pending, lfs_block_t b)
+{
+    return (pending[b / 2] >> ((b & 1) * 4)) & 0xF;
+}
+
+static void read_table(void)
+{
+    for (lfs_block_t b = 0; b < BLOCKS; b += WEAR_CHUNK) {
+        REQUIRE(wear_read_chunk(FLASH2, wear2.cur, b, MIN(WEAR_CHUNK, BLOCKS - b), &table[b]) == 0);
+    }
+}
+
+/* Runs single-threaded, so the flush lock is only ever held by a write-back
+ * under way; its copy is erased by the time it programs anything */
+static void snapshot(struct mx25l *m, uint32_t addr)
+{
+    memcpy(cut.pending, wear2_pending, sizeof(cut.pending));
+    cut.saturated = wear2.lost;
+    cut.in_flush = (wear_flush_lock.lock_count > 0);
+    cut.next = (wear2.cur == 0) ? 1 : 0;
+    cut.in_header = cut.in_flush && addr == wear_copy_addr(FLASH2, cut.next);
+    cut.seq = wear2.seq;
+}
+
+static void arm_cut(long budget)
+{
+    mx25l_flash2.cut_budget = budget;
+    mx25l_flash2.on_cut = snapshot;
+}
+
+/* Power back on: RAM state gone and the wear table reloaded */
+static void reboot(void)
+{
+    mx25l_power_cycle(&mx25l_flash2);
+    memset(wear2_pending, 0, sizeof(wear2_pending));
+    wear2.pending_total = 0;
+    wear2.lost = 0;
+    wear2.due = false;
+    wear2.cur = -1;
+    wear2.seq = 0;
+    wear_load(FLASH2);
+}
+
+/* The rest of the boot, which may erase again: raw log recovery and mount */
+static void restart(void)
+{
+    rawlog = (typeof(rawlog)){.head = RAWLOG_NONE};
+    REQUIRE(nor_flash_rawlog_recover() >= 0);
+
+    k_mutex_lock(&lfs2_lock, K_FOREVER);
+    lfs_unmount(&lfs2);
+    memset(&lfs2, 0, sizeof(lfs2));
+    lfs2_mounted = (lfs_init_mount(FLASH2) == 0);
+    k_mutex_unlock(&lfs2_lock);
+    REQUIRE(lfs2_mounted);
+}
+
+/* Add up what the cut cost, then hold the stored table to the model */
+static void check_after_reboot(void)
+{
+    lfs_block_t copy = wear_copy_addr(FLASH2, cut.next) / FLASH_SECTOR_SIZE;
+    bool committed = cut.in_header && wear2.seq == cut.seq + 1;
+    uint32_t wrong = 0;
+
+    CHECK_EQ(cut.saturated, 0);
+    for (lfs_block_t b = 0; b < BLOCKS; b++) {
+        /* A header whose last bytes needed no programming commits anyway,
+         * with every pending count in it */
+        if (!committed) lost[b] += pending_of(cut.pending, b);
+        if (cut.in_flush && b >= copy && b < copy + WEAR_COPY_BLOCKS(BLOCKS)) lost[b]++;
+    }
+
+    read_table();
+    for (lfs_block_t b = 0; b < BLOCKS; b++) {
+        if (table[b] + lost[b] != mx25l_flash2.erase_counts[b] && wrong++ == 0) {
+            fprintf(stderr, "block %u: stored %u + lost %u, erased %u times\n",
+                    (unsigned)b, table[b], lost[b], mx25l_flash2.erase_counts[b]);
+        }
+    }
+    CHECK_EQ(wrong, 0);
+}
+
+static void write_daily(uint32_t day)
+{
+    char cfg[256];
+    nor_flash_file_t *h;
+
+    memset(cfg, (int)(day & 0x7F), sizeof(cfg));
+    REQUIRE(nor_flash_write_file(FLASH2, "config.bin", cfg, sizeof(cfg)) == 0);
+    REQUIRE(nor_flash_open(FLASH2, "events.log", NOR_FLASH_MODE_APPEND, &h) == 0);
+    REQUIRE(nor_flash_append(h, cfg, 64) == 0);
+    REQUIRE(nor_flash_close(h) == 0);
+}
+
+/* The day's recording; false if the power went */
+static bool record_day(uint32_t day)
+{
+    for (int r = 0; r < RECORDS; r++) {
+        memset(record, (int)((day + r) & 0x7F), sizeof(record));
+        int ret = nor_flash_rawlog_append(record, sizeof(record), day * 86400 + r);
+        if (mx25l_flash2.power_lost) return false;
+        REQUIRE(ret == 0);
+
+        if (wear2.due && mx25l_flash2.cut_budget == MX25L_NO_FAULT && rnd(FLUSH_CUT_ONE_IN) == 0) {
+            arm_cut(rnd(BLOCKS * sizeof(uint16_t) + WEAR_HDR_SIZE));
+        }
+        host_work_run();
+        if (mx25l_flash2.power_lost) return false;
+    }
+    return true;
+}
+
+static void report_range(const char *what, lfs_block_t first, lfs_block_t end)
+{
+    uint32_t min = UINT32_MAX, max = 0;
+    uint64_t sum = 0;
+    char metric[48];
+
+    for (lfs_block_t b = first; b < end; b++) {
+        min = MIN(min, table[b]);
+        max = MAX(max, table[b]);
+        sum += table[b];
+    }
+    snprintf(metric, sizeof(metric), "%s.min", what);
+    host_bench(metric, min, "erases");
+    snprintf(metric, sizeof(metric), "%s.max", what);
+    host_bench(metric, max, "erases");
+    snprintf(metric, sizeof(metric), "%s.mean", what);
+    host_bench(metric, (double)sum / (end - first), "erases");
+}
+
+static void test_years(void)
+{
+    struct nor_flash_wear wear;
+
+    host_boot_blank();
+    host_work_run();
+    for (uint32_t day = 0; day < DAYS; day++) {
+        if (rnd(CUT_EVERY) == 0) arm_cut(rnd(RECORDS * RECORD_SIZE));
+
+        bool up = record_day(day);
+        if (up) {
+            /* Cuts are kept out of LittleFS, which has power-loss tests of its own */
+            mx25l_flash2.cut_budget = MX25L_NO_FAULT;
+            write_daily(day);
+            host_work_run();
+            continue;
+        }
+        cuts++;
+        flush_cuts += cut.in_flush;
+        reboot();
+        check_after_reboot();
+        restart();
+    }
+
+    /* A clean shutdown after a last write-back loses only its copy's erase */
+    REQUIRE(nor_flash_wear_flush(FLASH2) == 0);
+    snapshot(&mx25l_flash2, 0);
+    reboot();
+    check_after_reboot();
+
+    CHECK(cuts > DAYS / CUT_EVERY / 2);
+    CHECK(flush_cuts > 0);
+    host_bench("cuts", cuts, "count");
+    host_bench("flush_cuts", flush_cuts, "count");
+
+    /* The API's view matches the stored table */
+    REQUIRE(nor_flash_get_wear(FLASH2, &wear) == 0);
+    uint64_t total = 0;
+    for (lfs_block_t b = 0; b < BLOCKS; b++) total += table[b];
+    CHECK_EQ(wear.total, total);
+    CHECK_EQ(wear.lost, 0);
+    host_bench("all.min", wear.min, "erases");
+    host_bench("all.max", wear.max, "erases");
+    host_bench("all.mean", (double)wear.total / wear.blocks, "erases");
+    report_range("lfs", 0, FLASH2_LFS_BLOCKS);
+    report_range("rawlog", RAWLOG_FIRST_BLOCK, RAWLOG_END_BLOCK);
+    report_range("table", FLASH2_WEAR_BLOCK, BLOCKS);
+    for (int i = 0; i < NOR_FLASH_WEAR_BUCKETS; i++) {
+        if (wear.hist[i]) printf("  %6u-%6u: %5u blocks\n", i * wear.bucket_width,
+                                 (i + 1) * wear.bucket_width - 1, wear.hist[i]);
+    }
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"years", test_years},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
@@ -0,0 +1,75 @@
+/*
+ * Host test support: runner, checks and control of the kernel shim
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Run the work items submitted so far; returns how many ran */
+int host_work_run(void);
+
+/* Virtual clock, microseconds since start */
+int64_t host_time_us(void);
+
+/*
+ * If set, sees every SPI1 transfer before it is clocked. Returning nonzero
+ * completes the transfer in place of the bus and the chip, in which case
+ * the hook fills the RX buffers itself.
+ */
+struct spi_buf_set;
+extern int (*host_spi_hook)(const struct spi_buf_set *tx, const struct spi_buf_set *rx);
+
+extern int host_failures;
+
+/*
+ * Benchmark result of the running case: printed, and appended as a CSV row
+ * (bench,case,metric,value,unit) to the file HOST_BENCH_OUT names, if set.
+ * bench is the executable's name, so one per build configuration.
+ */
+void host_bench(const char *metric, double value, const char *unit);
+
+#define CHECK(cond)                                                                     \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond);    \
+            host_failures++;                                                            \
+        }                                                                               \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                  \
+    do {                                                                                \
+        long long _a = (long long)(a), _b = (long long)(b);                             \
+        if (_a != _b) {                                                                 \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %lld, expected %s == %lld\n", \
+                    __FILE__, __LINE__, #a, _a, #b, _b);                                \
+            host_failures++;                                                            \
+        }                                                                               \
+    } while (0)
+
+/* Abort the current test early (a later check would only cascade) */
+#define REQUIRE(cond)                                                                   \
+    do {                                                                                \
+        if (!(cond)) {                                                                  \
+            fprintf(stderr, "%s:%d: REQUIRE failed: %s\n", __FILE__, __LINE__, #cond);  \
+            exit(1);                                                                    \
+        }                                                                               \
+    } while (0)
+
+struct host_test {
+    const char *name;
+    void (*fn)(void);
+};
+
+/*
+ * Runs the test named on the command line. nor_flash.c keeps its state in
+ * statics, so every test gets a process of its own; without an argument
+ * the names are listed.
+ */
+int host_main(int argc, char **argv, const struct host_test *tests, size_t count);
+
+#endif /* HOST_H */
@@ -0,0 +1,769 @@
+/*
+ * Host implementation of the Zephyr APIs declared under include/zephyr,
+ * plus the test runner (host.h)
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/timeutil.h>
+#include <zephyr/timing/timing.h>
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+
+#include "host.h"
+#include "mx25l_model.h"
+
+int host_failures;
+
+static void host_fatal(const char *what)
+{
+    fprintf(stderr, "host: %s would block forever\n", what);
+    abort();
+}
+
+/*============================================================================
+ * Time - virtual, advanced by busy-waits, and by sleeps and bus transfers
+ * when no other thread is ready
+ *============================================================================*/
+
+/* Nanoseconds, so a few bytes on a fast bus still add up */
+static int64_t now_ns;
+
+int64_t host_time_us(void)
+{
+    return now_ns / 1000;
+}
+
+static void host_advance_ns(int64_t ns)
+{
+    now_ns += ns;
+}
+
+static void host_sleep_ns(int64_t ns);
+
+int32_t k_msleep(int32_t ms)
+{
+    host_sleep_ns((int64_t)ms * 1000000);
+    return 0;
+}
+
+int32_t k_usleep(int32_t us)
+{
+    host_sleep_ns((int64_t)us * 1000);
+    return 0;
+}
+
+void k_busy_wait(uint32_t usec)
+{
+    host_advance_ns((int64_t)usec * 1000);
+}
+
+int64_t k_uptime_get(void)
+{
+    return now_ns / 1000000;
+}
+
+uint32_t k_uptime_get_32(void)
+{
+    return (uint32_t)k_uptime_get();
+}
+
+uint32_t k_cycle_get_32(void)
+{
+    return (uint32_t)host_time_us();
+}
+
+uint64_t k_cyc_to_us_floor64(uint64_t cyc)
+{
+    return cyc;
+}
+
+uint32_t k_cyc_to_us_floor32(uint32_t cyc)
+{
+    return cyc;
+}
+
+void timing_init(void)
+{
+}
+
+void timing_start(void)
+{
+}
+
+timing_t timing_counter_get(void)
+{
+    return (timing_t)now_ns;
+}
+
+uint64_t timing_cycles_get(volatile timing_t *const start, volatile timing_t *const end)
+{
+    return *end - *start;
+}
+
+uint64_t timing_cycles_to_ns(uint64_t cycles)
+{
+    return cycles;
+}
+
+int64_t timeutil_timegm64(const struct tm *tm)
+{
+    struct tm copy = *tm;
+    return (int64_t)timegm(&copy);
+}
+
+/*============================================================================
+ * Threads - cooperative, on the virtual clock
+ *
+ * A thread runs until it blocks: on a mutex, semaphore, condition variable,
+ * message queue or poll, in a sleep, or for the length of a bus transfer.
+ * The highest priority ready thread runs next, the longest waiting first
+ * among equals; with none ready the clock jumps to the next timeout. Waking
+ * or creating a higher priority thread switches to it at once, as on the
+ * board; otherwise nothing preempts, so k_busy_wait() holds the CPU.
+ *============================================================================*/
+
+#define HOST_STACK_SIZE  (1024 * 1024)
+
+enum {
+    HOST_READY,
+    HOST_WAITING,      /* On wait_on (NULL: a sleep) until woken or wake_ns */
+    HOST_IDLE,         /* Created with K_FOREVER, not started yet */
+    HOST_DONE,
+};
+
+static ucontext_t main_context;
+static struct k_thread main_thread = {.started = true, .context = &main_context};
+static struct k_thread *current = &main_thread;
+static struct k_thread *threads = &main_thread;
+static uint64_t host_seq;
+
+static void host_ready(struct k_thread *t, int result)
+{
+    t->state = HOST_READY;
+    t->wait_on = NULL;
+    t->wait_result = result;
+    t->seq = ++host_seq;
+}
+
+static bool host_before(const struct k_thread *a, const struct k_thread *b)
+{
+    return b == NULL || a->prio < b->prio || (a->prio == b->prio && a->seq < b->seq);
+}
+
+/* The waiter on obj to wake first */
+static struct k_thread *host_waiter(const void *obj)
+{
+    struct k_thread *best = NULL;
+
+    for (struct k_thread *t = threads; t; t = t->next) {
+        if (t->state == HOST_WAITING && t->wait_on == obj && host_before(t, best)) best = t;
+    }
+    return best;
+}
+
+/* Run the next thread; returns when the current one is picked again */
+static void host_schedule(void)
+{
+    struct k_thread *prev = current, *next;
+
+    while (true) {
+        int64_t wake = INT64_MAX;
+
+        next = NULL;
+        for (struct k_thread *t = threads; t; t = t->next) {
+            if (t->state == HOST_WAITING && t->wake_ns >= 0) {
+                if (t->wake_ns <= now_ns) {
+                    host_ready(t, -EAGAIN);
+                } else {
+                    wake = MIN(wake, t->wake_ns);
+                }
+            }
+            if (t->state == HOST_READY && host_before(t, next)) next = t;
+        }
+        if (next) break;
+        if (wake == INT64_MAX) host_fatal("every thread");
+        now_ns = wake;
+    }
+    if (next == prev) return;
+    current = next;
+    swapcontext(prev->context, next->context);
+}
+
+/* After waking threads: one of higher priority than the caller runs now */
+static void host_preempt(void)
+{
+    for (struct k_thread *t = threads; t; t = t->next) {
+        if (t->state == HOST_READY && t != current && t->prio < current->prio) {
+            host_ready(current, 0);
+            host_schedule();
+            return;
+        }
+    }
+}
+
+/* Block the current thread on obj until woken (the waker's result) or until
+ * the deadline passes (-EAGAIN); deadline -1 for never */
+static int host_block_until(const void *obj, int64_t deadline_ns)
+{
+    current->state = HOST_WAITING;
+    current->wait_on = obj;
+    current->wake_ns = deadline_ns;
+    current->seq = ++host_seq;
+    host_schedule();
+    return current->wait_result;
+}
+
+static int host_block(const void *obj, k_timeout_t timeout)
+{
+    if (timeout.us == 0) return -EAGAIN;
+    return host_block_until(obj, (timeout.us < 0) ? -1 : now_ns + timeout.us * 1000);
+}
+
+static void host_sleep_ns(int64_t ns)
+{
+    host_block_until(NULL, now_ns + ns);
+}
+
+static void host_thread_main(void)
+{
+    struct k_thread *t = current;
+    struct k_thread *joiner;
+
+    t->entry(t->p1, t->p2, t->p3);
+    t->state = HOST_DONE;
+    while ((joiner = host_waiter(t)) != NULL) {
+        host_ready(joiner, 0);
+    }
+    host_schedule();
+}
+
+k_tid_t k_thread_create(struct k_thread *new_thread, char *stack, size_t stack_size,
+                        k_thread_entry_t entry, void *p1, void *p2, void *p3,
+                        int prio, uint32_t options, k_timeout_t delay)
+{
+    struct k_thread *t = new_thread;
+
+    /* A thread object used again once its thread is done, as a second boot
+     * does: off the list, and its host stack freed */
+    for (struct k_thread **p = &threads; *p; p = &(*p)->next) {
+        if (*p != t) continue;
+        if (t->state != HOST_DONE) {
+            fprintf(stderr, "host: k_thread_create on a live thread\n");
+            abort();
+        }
+        *p = t->next;
+        free(t->host_stack);
+        free(t->context);
+        break;
+    }
+
+    ucontext_t *ctx = calloc(1, sizeof(*ctx));
+    void *host_stack = malloc(HOST_STACK_SIZE);
+
+    if (ctx == NULL || host_stack == NULL || getcontext(ctx) != 0) {
+        fprintf(stderr, "host: cannot create a thread\n");
+        abort();
+    }
+    ctx->uc_stack.ss_sp = host_stack;
+    ctx->uc_stack.ss_size = HOST_STACK_SIZE;
+    ctx->uc_link = NULL;
+    makecontext(ctx, host_thread_main, 0);
+
+    *t = (struct k_thread){
+        .entry = entry, .p1 = p1, .p2 = p2, .p3 = p3,
+        .prio = prio, .context = ctx, .host_stack = host_stack, .state = HOST_IDLE,
+    };
+    struct k_thread **tail = &threads;
+    while (*tail) tail = &(*tail)->next;
+    *tail = t;
+
+    if (delay.us == 0) {
+        k_thread_start(t);
+    } else if (delay.us > 0) {
+        t->started = true;
+        t->state = HOST_WAITING;
+        t->wake_ns = now_ns + delay.us * 1000;
+    }
+    host_preempt();
+    return t;
+}
+
+int k_thread_join(struct k_thread *thread, k_timeout_t timeout)
+{
+    if (thread->state == HOST_DONE) return 0;
+    if (thread == current) return -EDEADLK;
+    return (host_block(thread, timeout) == 0) ? 0 : (timeout.us == 0) ? -EBUSY : -EAGAIN;
+}
+
+/* Threads from K_THREAD_DEFINE have no context and never run */
+void k_thread_start(k_tid_t thread)
+{
+    thread->started = true;
+    if (thread->context && thread->state == HOST_IDLE) host_ready(thread, 0);
+}
+
+k_tid_t k_current_get(void)
+{
+    return current;
+}
+
+int k_thread_priority_get(k_tid_t thread)
+{
+    return thread->prio;
+}
+
+/*============================================================================
+ * Synchronization
+ *============================================================================*/
+
+int k_mutex_init(struct k_mutex *mutex)
+{
+    mutex->lock_count = 0;
+    mutex->owner = NULL;
+    return 0;
+}
+
+int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout)
+{
+    if (mutex->owner == NULL || mutex->owner == current) {
+        mutex->owner = current;
+        mutex->lock_count++;
+        return 0;
+    }
+    if (timeout.us == 0) return -EBUSY;
+    /* The unlock hands the mutex over before waking us */
+    return (host_block(mutex, timeout) == 0) ? 0 : -EAGAIN;
+}
+
+int k_mutex_unlock(struct k_mutex *mutex)
+{
+    if (mutex->lock_count == 0 || mutex->owner != current) {
+        fprintf(stderr, "host: unlock of a mutex this thread does not hold\n");
+        abort();
+    }
+    if (--mutex->lock_count > 0) return 0;
+
+    struct k_thread *next = host_waiter(mutex);
+    mutex->owner = next;
+    if (next) {
+        mutex->lock_count = 1;
+        host_ready(next, 0);
+        host_preempt();
+    }
+    return 0;
+}
+
+int k_sem_init(struct k_sem *sem, unsigned int initial_count, unsigned int limit)
+{
+    sem->count = initial_count;
+    sem->limit = limit;
+    return 0;
+}
+
+int k_sem_take(struct k_sem *sem, k_timeout_t timeout)
+{
+    if (sem->count > 0) {
+        sem->count--;
+        return 0;
+    }
+    if (timeout.us == 0) return -EBUSY;
+    return host_block(sem, timeout);
+}
+
+void k_sem_give(struct k_sem *sem)
+{
+    struct k_thread *t = host_waiter(sem);
+
+    if (t) {
+        host_ready(t, 0);
+        host_preempt();
+    } else if (sem->count < sem->limit) {
+        sem->count++;
+    }
+}
+
+void k_sem_reset(struct k_sem *sem)
+{
+    struct k_thread *t;
+
+    sem->count = 0;
+    while ((t = host_waiter(sem)) != NULL) {
+        host_ready(t, -EAGAIN);
+    }
+    host_preempt();
+}
+
+int k_condvar_init(struct k_condvar *condvar)
+{
+    ARG_UNUSED(condvar);
+    return 0;
+}
+
+int k_condvar_signal(struct k_condvar *condvar)
+{
+    struct k_thread *t = host_waiter(condvar);
+
+    if (t) {
+        host_ready(t, 0);
+        host_preempt();
+    }
+    return 0;
+}
+
+int k_condvar_broadcast(struct k_condvar *condvar)
+{
+    struct k_thread *t;
+    int woken = 0;
+
+    while ((t = host_waiter(condvar)) != NULL) {
+        host_ready(t, 0);
+        woken++;
+    }
+    host_preempt();
+    return woken;
+}
+
+int k_condvar_wait(struct k_condvar *condvar, struct k_mutex *mutex, k_timeout_t timeout)
+{
+    k_mutex_unlock(mutex);
+    int ret = host_block(condvar, timeout);
+    k_mutex_lock(mutex, K_FOREVER);
+    return ret;
+}
+
+static struct k_work *work_pending[8];
+static size_t work_count;
+
+void k_work_queue_init(struct k_work_q *queue)
+{
+    queue->started = false;
+}
+
+void k_work_queue_start(struct k_work_q *queue, char *stack, size_t stack_size,
+                        int prio, const void *cfg)
+{
+    queue->started = true;
+}
+
+int k_work_submit_to_queue(struct k_work_q *queue, struct k_work *work)
+{
+    if (!queue->started) return -ENODEV;
+    if (work->pending) return 0;
+    if (work_count == ARRAY_SIZE(work_pending)) {
+        fprintf(stderr, "host: work queue full\n");
+        abort();
+    }
+    work->pending = true;
+    work_pending[work_count++] = work;
+    return 1;
+}
+
+int host_work_run(void)
+{
+    int ran = 0;
+
+    while (work_count > 0) {
+        struct k_work *work = work_pending[0];
+        memmove(&work_pending[0], &work_pending[1], --work_count * sizeof(work_pending[0]));
+        work->pending = false;
+        work->handler(work);
+        ran++;
+    }
+    return ran;
+}
+
+/* Getters wait on msgq->used, putters on msgq->read */
+int k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t timeout)
+{
+    while (msgq->used == msgq->max_msgs) {
+        if (timeout.us == 0) return -ENOMSG;
+        if (host_block(&msgq->read, timeout) != 0) return -EAGAIN;
+    }
+    uint32_t slot = (msgq->read + msgq->used) % msgq->max_msgs;
+    memcpy(msgq->buffer + slot * msgq->msg_size, data, msgq->msg_size);
+    msgq->used++;
+
+    struct k_thread *t = host_waiter(&msgq->used);
+    if (t) {
+        host_ready(t, 0);
+        host_preempt();
+    }
+    return 0;
+}
+
+int k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout)
+{
+    while (msgq->used == 0) {
+        if (timeout.us == 0) return -ENOMSG;
+        if (host_block(&msgq->used, timeout) != 0) return -EAGAIN;
+    }
+    memcpy(data, msgq->buffer + msgq->read * msgq->msg_size, msgq->msg_size);
+    msgq->read = (msgq->read + 1) % msgq->max_msgs;
+    msgq->used--;
+
+    struct k_thread *t = host_waiter(&msgq->read);
+    if (t) {
+        host_ready(t, 0);
+        host_preempt();
+    }
+    return 0;
+}
+
+void k_poll_signal_init(struct k_poll_signal *sig)
+{
+    sig->signaled = 0;
+    sig->result = 0;
+}
+
+int k_poll_signal_raise(struct k_poll_signal *sig, int result)
+{
+    struct k_thread *t;
+
+    sig->signaled = 1;
+    sig->result = result;
+    while ((t = host_waiter(sig)) != NULL) {
+        host_ready(t, 0);
+    }
+    host_preempt();
+    return 0;
+}
+
+void k_poll_event_init(struct k_poll_event *event, uint32_t type, int mode, void *obj)
+{
+    event->signal = obj;
+}
+
+/* Waits on the first event's signal; the driver polls one at a time */
+int k_poll(struct k_poll_event *events, int num_events, k_timeout_t timeout)
+{
+    while (true) {
+        for (int i = 0; i < num_events; i++) {
+            if (events[i].signal->signaled) return 0;
+        }
+        if (timeout.us == 0) return -EAGAIN;
+        if (host_block(events[0].signal, timeout) != 0) return -EAGAIN;
+    }
+}
+
+/*============================================================================
+ * Devices - SPI1 with FLASH1 on it, FLASH2 through the flash API
+ *============================================================================*/
+
+/* Driver call, DMA start and chip select around each transfer */
+#ifndef HOST_XFER_SETUP_US
+#define HOST_XFER_SETUP_US  5
+#endif
+
+const struct device host_device_spi1 = {.name = "spi1", .data = &mx25l_flash1};
+const struct device host_device_mx25l51245g = {.name = "mx25l51245g", .data = &mx25l_flash2};
+
+/* nordic,qspi-nor checks the JEDEC ID in its init */
+bool device_is_ready(const struct device *dev)
+{
+    struct mx25l *m = dev->data;
+
+    if (m->timing.ready_delay_us > 0) host_sleep_ns((int64_t)m->timing.ready_delay_us * 1000);
+    return m->mem != NULL && (dev != &host_device_mx25l51245g || !m->floating);
+}
+
+/* The controllers' own locks: one transfer at a time on each bus */
+static K_MUTEX_DEFINE(spi1_lock);
+static K_MUTEX_DEFINE(qspi_lock);
+
+int (*host_spi_hook)(const struct spi_buf_set *tx, const struct spi_buf_set *rx);
+
+/* One chip-select assertion: TX and RX clock together, NULL buffers are
+ * skipped. The command takes effect when CS goes high, after the clocking;
+ * the calling thread sleeps through it as it does on the DMA. */
+int spi_transceive(const struct device *dev, const struct spi_config *config,
+                   const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+    size_t tx_len = 0, rx_len = 0;
+
+    if (host_spi_hook && host_spi_hook(tx_bufs, rx_bufs)) return 0;
+    for (size_t i = 0; i < tx_bufs->count; i++) tx_len += tx_bufs->buffers[i].len;
+    for (size_t i = 0; rx_bufs && i < rx_bufs->count; i++) rx_len += rx_bufs->buffers[i].len;
+
+    size_t len = MAX(tx_len, rx_len);
+    uint8_t *mosi = calloc(1, len + 1);
+    uint8_t *miso = malloc(len + 1);
+    size_t pos = 0;
+
+    for (size_t i = 0; i < tx_bufs->count; i++) {
+        const struct spi_buf *b = &tx_bufs->buffers[i];
+        if (b->buf) memcpy(mosi + pos, b->buf, b->len);
+        pos += b->len;
+    }
+
+    k_mutex_lock(&spi1_lock, K_FOREVER);
+    host_sleep_ns(HOST_XFER_SETUP_US * 1000 + (int64_t)len * 8 * 1000000000 / config->frequency);
+    int ret = mx25l_spi_xfer(dev->data, mosi, tx_len, miso, len);
+    k_mutex_unlock(&spi1_lock);
+
+    pos = 0;
+    for (size_t i = 0; rx_bufs && i < rx_bufs->count; i++) {
+        const struct spi_buf *b = &rx_bufs->buffers[i];
+        if (b->buf) memcpy(b->buf, miso + pos, b->len);
+        pos += b->len;
+    }
+    free(mosi);
+    free(miso);
+    return ret;
+}
+
+/* Command and data phase of one QSPI operation */
+static void qspi_xfer(const struct mx25l *m, size_t len)
+{
+    host_sleep_ns(HOST_XFER_SETUP_US * 1000 + (int64_t)len * 1000 / m->timing.read_mbps);
+}
+
+/* The nordic,qspi-nor calls return once the chip is idle again */
+static void qspi_wait_ready(const struct mx25l *m)
+{
+    int64_t until_ns = m->busy_until_us * 1000;
+    if (until_ns > now_ns) host_sleep_ns(until_ns - now_ns);
+}
+
+int flash_read(const struct device *dev, off_t offset, void *data, size_t len)
+{
+    struct mx25l *m = dev->data;
+
+    if (offset < 0 || (size_t)offset > m->size || len > m->size - offset) return -EINVAL;
+    k_mutex_lock(&qspi_lock, K_FOREVER);
+    qspi_xfer(m, len);
+    if (m->floating) {
+        memset(data, 0xFF, len);
+    } else {
+        memcpy(data, &m->mem[offset], len);
+    }
+    k_mutex_unlock(&qspi_lock);
+    return 0;
+}
+
+/* One page program per page touched, as the driver issues them */
+int flash_write(const struct device *dev, off_t offset, const void *data, size_t len)
+{
+    struct mx25l *m = dev->data;
+    const uint8_t *src = data;
+    int ret = 0;
+
+    if (offset < 0) return -EINVAL;
+    if (m->floating) return -EIO;   /* WIP reads back set until the driver times out */
+    k_mutex_lock(&qspi_lock, K_FOREVER);
+    while (len > 0 && ret == 0) {
+        size_t step = MIN(len, 256 - (size_t)offset % 256);
+        qspi_xfer(m, step);
+        ret = mx25l_program(m, (uint32_t)offset, src, step);
+        qspi_wait_ready(m);
+        offset += step;
+        src += step;
+        len -= step;
+    }
+    k_mutex_unlock(&qspi_lock);
+    return ret;
+}
+
+/* Chip erase for the whole chip, 64KB blocks where aligned, else sectors */
+int flash_erase(const struct device *dev, off_t offset, size_t size)
+{
+    struct mx25l *m = dev->data;
+    int ret = 0;
+
+    if (offset < 0 || (offset % 4096) != 0 || (size % 4096) != 0) return -EINVAL;
+    if ((size_t)offset > m->size || size > m->size - offset) return -EINVAL;
+    if (m->floating) return -EIO;
+    k_mutex_lock(&qspi_lock, K_FOREVER);
+    while (size > 0 && ret == 0) {
+        size_t step = (offset == 0 && size == m->size) ? size :
+                      ((offset % 65536) == 0 && size >= 65536) ? 65536 : 4096;
+        qspi_xfer(m, 0);
+        ret = mx25l_erase(m, (uint32_t)offset, step);
+        qspi_wait_ready(m);
+        offset += step;
+        size -= step;
+    }
+    k_mutex_unlock(&qspi_lock);
+    return ret;
+}
+
+int flash_read_jedec_id(const struct device *dev, uint8_t *id)
+{
+    return mx25l_read_jedec_id(dev->data, id);
+}
+
+int flash_sfdp_read(const struct device *dev, off_t offset, void *data, size_t len)
+{
+    if (offset < 0) return -EINVAL;
+    return mx25l_read_sfdp(dev->data, (uint32_t)offset, data, len);
+}
+
+/*============================================================================
+ * Logging and the runner
+ *============================================================================*/
+
+void host_log(const char *module, char level, const char *fmt, ...)
+{
+    static int verbose = -1;
+    va_list ap;
+
+    if (verbose < 0) verbose = (getenv("HOST_LOG") != NULL);
+    if (!verbose && level != 'E' && level != 'W') return;
+
+    fprintf(stderr, "[%8lld.%03lld] <%c> %s: ", (long long)(now_ns / 1000000000),
+            (long long)(now_ns / 1000000 % 1000), level, module);
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+static const char *bench_name, *case_name;
+
+void host_bench(const char *metric, double value, const char *unit)
+{
+    const char *path = getenv("HOST_BENCH_OUT");
+
+    printf("%s.%s %s = %.3f %s\n", bench_name, case_name, metric, value, unit);
+    if (path == NULL || *path == '\0') return;
+
+    FILE *f = fopen(path, "a");
+    if (f == NULL) {
+        fprintf(stderr, "host: cannot open %s\n", path);
+        host_failures++;
+        return;
+    }
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) == 0) fprintf(f, "bench,case,metric,value,unit\n");
+    fprintf(f, "%s,%s,%s,%.3f,%s\n", bench_name, case_name, metric, value, unit);
+    fclose(f);
+}
+
+int host_main(int argc, char **argv, const struct host_test *tests, size_t count)
+{
+    const char *slash = strrchr(argv[0], '/');
+
+    bench_name = slash ? slash + 1 : argv[0];
+    if (argc != 2) {
+        for (size_t i = 0; i < count; i++) {
+            printf("%s\n", tests[i].name);
+        }
+        return (argc == 1) ? 0 : 2;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(argv[1], tests[i].name) == 0) {
+            case_name = tests[i].name;
+            tests[i].fn();
+            printf("%s: %s\n", tests[i].name, host_failures ? "FAILED" : "passed");
+            return host_failures ? 1 : 0;
+        }
+    }
+    fprintf(stderr, "no test named %s\n", argv[1]);
+    return 2;
+}
@@ -0,0 +1,37 @@
+/*
+ * nor_flash.c built into the test itself, so tests can reach its static
+ * state, plus bring-up helpers on the RAM flash model. Include once, from
+ * the test's only source file.
+ */
+
+#ifndef HOST_NOR_FLASH_H
+#define HOST_NOR_FLASH_H
+
+#include "nor_flash.c"
+
+#include "host.h"
+#include "mx25l_model.h"
+
+/* Blank chips, then the boot sequence main.c runs (both stages). Mount does
+ * not format them unless the test is built with NOR_FLASH_FORMAT_BLANK, so
+ * they are provisioned with nor_flash_format() in between. */
+static __maybe_unused void host_boot_blank(void)
+{
+    mx25l_init(FLASH1_CHIP_SIZE_BYTES, FLASH1_CHIP_JEDEC_ID, FLASH2_CHIP_SIZE_BYTES, FLASH2_CHIP_JEDEC_ID);
+    nor_flash_system_mount();
+    if (!NOR_FLASH_FORMAT_BLANK) {
+        REQUIRE(nor_flash_format(FLASH1, false) == 0);
+        REQUIRE(nor_flash_format(FLASH2, false) == 0);
+    }
+    REQUIRE(nor_flash_system_start() == 0);
+    REQUIRE(lfs1_mounted && lfs2_mounted);
+}
+
+/* The model saw only well-formed command sequences */
+static __maybe_unused void host_check_bus(void)
+{
+    CHECK_EQ(mx25l_flash1.bad_cmds, 0);
+    CHECK_EQ(mx25l_flash2.bad_cmds, 0);
+}
+
+#endif /* HOST_NOR_FLASH_H */
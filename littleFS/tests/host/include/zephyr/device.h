@@ -0,0 +1,25 @@
+/*
+ * Host build of the Zephyr device model: the two devices nor_flash.c gets
+ * from devicetree, both backed by the RAM flash model (mx25l_model.h)
+ */
+
+#ifndef HOST_ZEPHYR_DEVICE_H
+#define HOST_ZEPHYR_DEVICE_H
+
+#include <stdbool.h>
+
+struct device {
+    const char *name;
+    void *data;                  /* struct mx25l */
+};
+
+/* One level of indirection so DT_NODELABEL() expands first */
+#define HOST_DEVICE(node)        (&host_device_##node)
+#define DEVICE_DT_GET(node)      HOST_DEVICE(node)
+
+extern const struct device host_device_spi1;          /* SPIM1 bus with FLASH1 on it */
+extern const struct device host_device_mx25l51245g;   /* FLASH2 behind nordic,qspi-nor */
+
+bool device_is_ready(const struct device *dev);
+
+#endif /* HOST_ZEPHYR_DEVICE_H */
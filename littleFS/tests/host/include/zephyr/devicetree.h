@@ -0,0 +1,26 @@
+/*
+ * Host build of the devicetree macros nor_flash.c uses. Nodes are plain
+ * tokens; properties and node ids are looked up by pasting them together.
+ * FLASH1 sits on spi1 as on the board.
+ */
+
+#ifndef HOST_ZEPHYR_DEVICETREE_H
+#define HOST_ZEPHYR_DEVICETREE_H
+
+#define DT_NODELABEL(label)          label
+#define DT_PROP(node, prop)          HOST_DT_PROP(node, prop)
+#define HOST_DT_PROP(node, prop)     host_dt_##node##_##prop
+#define DT_BUS(node)                 HOST_DT_BUS(node)
+#define HOST_DT_BUS(node)            host_dt_##node##_bus
+#define DT_SAME_NODE(a, b)           (HOST_DT_ID(a) == HOST_DT_ID(b))
+#define HOST_DT_ID(node)             HOST_DT_ID_(node)
+#define HOST_DT_ID_(node)            host_dt_##node##_id
+
+#define host_dt_spi1_id                         1
+#define host_dt_spi3_id                         3
+#define host_dt_mx25l12845g_id                  10
+#define host_dt_mx25l51245g_id                  11
+#define host_dt_mx25l12845g_bus                 spi1
+#define host_dt_mx25l12845g_spi_max_frequency   32000000
+
+#endif /* HOST_ZEPHYR_DEVICETREE_H */
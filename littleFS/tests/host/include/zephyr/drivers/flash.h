@@ -0,0 +1,19 @@
+/* Host build of the flash API, served by the MX25L model behind the device */
+
+#ifndef HOST_ZEPHYR_DRIVERS_FLASH_H
+#define HOST_ZEPHYR_DRIVERS_FLASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <zephyr/device.h>
+
+int flash_read(const struct device *dev, off_t offset, void *data, size_t len);
+int flash_write(const struct device *dev, off_t offset, const void *data, size_t len);
+int flash_erase(const struct device *dev, off_t offset, size_t size);
+
+/* CONFIG_FLASH_JESD216_API */
+int flash_read_jedec_id(const struct device *dev, uint8_t *id);
+int flash_sfdp_read(const struct device *dev, off_t offset, void *data, size_t len);
+
+#endif /* HOST_ZEPHYR_DRIVERS_FLASH_H */
@@ -0,0 +1,50 @@
+/*
+ * Host build of the SPI API. Transfers on host_device_spi1 are decoded by
+ * the MX25L model as one chip-select assertion each.
+ */
+
+#ifndef HOST_ZEPHYR_DRIVERS_SPI_H
+#define HOST_ZEPHYR_DRIVERS_SPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+
+struct spi_cs_control {
+    struct gpio_dt_spec gpio;
+    uint32_t delay;
+};
+
+struct spi_config {
+    uint32_t frequency;
+    uint16_t operation;
+    uint16_t slave;
+    struct spi_cs_control cs;
+};
+
+struct spi_buf {
+    void *buf;                   /* NULL: clock out zeros / drop what is read */
+    size_t len;
+};
+
+struct spi_buf_set {
+    const struct spi_buf *buffers;
+    size_t count;
+};
+
+#define SPI_WORD_SET(x)          ((x) << 5)
+#define SPI_TRANSFER_MSB         0
+#define SPI_OP_MODE_MASTER       0
+#define SPI_CS_CONTROL_INIT(node, delay_us) {.gpio = {0}, .delay = (delay_us)}
+
+int spi_transceive(const struct device *dev, const struct spi_config *config,
+                   const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs);
+
+static inline int spi_write(const struct device *dev, const struct spi_config *config,
+                            const struct spi_buf_set *tx_bufs)
+{
+    return spi_transceive(dev, config, tx_bufs, NULL);
+}
+
+#endif /* HOST_ZEPHYR_DRIVERS_SPI_H */
@@ -0,0 +1,217 @@
+/*
+ * Host build of the Zephyr kernel API used by nor_flash.c
+ *
+ * Threads (host_kernel.c): one runs until it blocks on a kernel object,
+ * sleeps, waits out a bus transfer or wakes a higher priority thread, then
+ * the highest priority ready thread goes on. Time is a virtual clock that busy-waits
+ * advance, and that jumps to the next timeout when every thread waits
+ * (k_cycle_get_32() counts its microseconds). Threads defined with
+ * K_THREAD_DEFINE are never run. Work items queue up until host_work_run()
+ * (host.h) runs them. If every thread would block forever the test aborts
+ * instead of hanging.
+ */
+
+#ifndef HOST_ZEPHYR_KERNEL_H
+#define HOST_ZEPHYR_KERNEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/atomic.h>
+
+#ifndef ENOTSUP
+#define ENOTSUP EOPNOTSUPP
+#endif
+
+#define BIT(n)                  (1UL << (n))
+#define ARRAY_SIZE(a)           (sizeof(a) / sizeof((a)[0]))
+#define DIV_ROUND_UP(n, d)      (((n) + (d) - 1) / (d))
+#define ARG_UNUSED(x)           (void)(x)
+#define CONTAINER_OF(ptr, type, field) ((type *)(((char *)(ptr)) - offsetof(type, field)))
+#define __aligned(x)            __attribute__((aligned(x)))
+#define __noinit
+#define __maybe_unused          __attribute__((unused))
+#ifndef MIN
+#define MIN(a, b)               ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b)               ((a) > (b) ? (a) : (b))
+#endif
+
+/* Timeouts in microseconds, -1 for forever */
+typedef struct {
+    int64_t us;
+} k_timeout_t;
+
+#define K_FOREVER               ((k_timeout_t){-1})
+#define K_NO_WAIT               ((k_timeout_t){0})
+#define K_USEC(x)               ((k_timeout_t){(x)})
+#define K_MSEC(x)               ((k_timeout_t){(int64_t)(x) * 1000})
+#define K_SECONDS(x)            ((k_timeout_t){(int64_t)(x) * 1000000})
+#define SYS_FOREVER_MS          (-1)
+
+#define K_LOWEST_APPLICATION_THREAD_PRIO 14
+#define K_PRIO_PREEMPT(x)       (x)
+#define K_PRIO_COOP(x)          (-(x))
+
+/* Time */
+int32_t k_msleep(int32_t ms);
+int32_t k_usleep(int32_t us);
+void k_busy_wait(uint32_t usec);
+int64_t k_uptime_get(void);
+uint32_t k_uptime_get_32(void);
+uint32_t k_cycle_get_32(void);            /* 1 cycle = 1us on host */
+uint64_t k_cyc_to_us_floor64(uint64_t cyc);
+uint32_t k_cyc_to_us_floor32(uint32_t cyc);
+
+/* Mutex (recursive) */
+struct k_thread;
+
+struct k_mutex {
+    uint32_t lock_count;
+    struct k_thread *owner;
+};
+
+#define K_MUTEX_DEFINE(name)    struct k_mutex name = {0}
+
+int k_mutex_init(struct k_mutex *mutex);
+int k_mutex_lock(struct k_mutex *mutex, k_timeout_t timeout);
+int k_mutex_unlock(struct k_mutex *mutex);
+
+/* Semaphore */
+struct k_sem {
+    unsigned int count;
+    unsigned int limit;
+};
+
+#define K_SEM_DEFINE(name, initial, max) struct k_sem name = {(initial), (max)}
+
+int k_sem_init(struct k_sem *sem, unsigned int initial_count, unsigned int limit);
+int k_sem_take(struct k_sem *sem, k_timeout_t timeout);
+void k_sem_give(struct k_sem *sem);
+void k_sem_reset(struct k_sem *sem);
+
+/* Condition variable */
+struct k_condvar {
+    int unused;
+};
+
+int k_condvar_init(struct k_condvar *condvar);
+int k_condvar_signal(struct k_condvar *condvar);
+int k_condvar_broadcast(struct k_condvar *condvar);
+int k_condvar_wait(struct k_condvar *condvar, struct k_mutex *mutex, k_timeout_t timeout);
+
+/* Spinlock */
+struct k_spinlock {
+    int unused;
+};
+
+typedef struct {
+    int key;
+} k_spinlock_key_t;
+
+static inline k_spinlock_key_t k_spin_lock(struct k_spinlock *l)
+{
+    ARG_UNUSED(l);
+    return (k_spinlock_key_t){0};
+}
+
+static inline void k_spin_unlock(struct k_spinlock *l, k_spinlock_key_t key)
+{
+    ARG_UNUSED(l);
+    ARG_UNUSED(key);
+}
+
+/* Threads */
+typedef void (*k_thread_entry_t)(void *p1, void *p2, void *p3);
+
+struct k_thread {
+    k_thread_entry_t entry;
+    void *p1, *p2, *p3;
+    int prio;
+    bool started;
+
+    /* Scheduler state, see host_kernel.c */
+    void *context;               /* ucontext_t; NULL for K_THREAD_DEFINE */
+    void *host_stack;
+    int state;
+    const void *wait_on;
+    int64_t wake_ns;             /* -1: no timeout */
+    int wait_result;
+    uint64_t seq;                /* Order of readying/blocking, FIFO among equals */
+    struct k_thread *next;
+};
+
+typedef struct k_thread *k_tid_t;
+
+#define K_THREAD_STACK_DEFINE(sym, size)    char sym[size]
+#define K_THREAD_STACK_SIZEOF(sym)          sizeof(sym)
+#define K_THREAD_DEFINE(name, stack_size, entry_fn, p1, p2, p3, prio, options, delay) \
+    static struct k_thread _k_thread_obj_##name = {.entry = (entry_fn)};              \
+    const k_tid_t name = &_k_thread_obj_##name
+
+k_tid_t k_thread_create(struct k_thread *new_thread, char *stack, size_t stack_size,
+                        k_thread_entry_t entry, void *p1, void *p2, void *p3,
+                        int prio, uint32_t options, k_timeout_t delay);
+int k_thread_join(struct k_thread *thread, k_timeout_t timeout);
+void k_thread_start(k_tid_t thread);
+k_tid_t k_current_get(void);
+int k_thread_priority_get(k_tid_t thread);
+
+/* Work queues */
+struct k_work;
+typedef void (*k_work_handler_t)(struct k_work *work);
+
+struct k_work {
+    k_work_handler_t handler;
+    bool pending;
+};
+
+struct k_work_q {
+    bool started;
+};
+
+#define K_WORK_DEFINE(work, work_handler) struct k_work work = {.handler = (work_handler)}
+
+void k_work_queue_init(struct k_work_q *queue);
+void k_work_queue_start(struct k_work_q *queue, char *stack, size_t stack_size,
+                        int prio, const void *cfg);
+int k_work_submit_to_queue(struct k_work_q *queue, struct k_work *work);
+
+/* Message queues */
+struct k_msgq {
+    char *buffer;
+    size_t msg_size;
+    uint32_t max_msgs;
+    uint32_t read;
+    uint32_t used;
+};
+
+#define K_MSGQ_DEFINE(name, size, max, align)                       \
+    static char _k_msgq_buf_##name[(size) * (max)];                 \
+    struct k_msgq name = {.buffer = _k_msgq_buf_##name, .msg_size = (size), .max_msgs = (max)}
+
+int k_msgq_put(struct k_msgq *msgq, const void *data, k_timeout_t timeout);
+int k_msgq_get(struct k_msgq *msgq, void *data, k_timeout_t timeout);
+
+/* Polling */
+struct k_poll_signal {
+    unsigned int signaled;
+    int result;
+};
+
+struct k_poll_event {
+    struct k_poll_signal *signal;
+};
+
+#define K_POLL_TYPE_SIGNAL       1
+#define K_POLL_MODE_NOTIFY_ONLY  0
+
+void k_poll_signal_init(struct k_poll_signal *sig);
+int k_poll_signal_raise(struct k_poll_signal *sig, int result);
+void k_poll_event_init(struct k_poll_event *event, uint32_t type, int mode, void *obj);
+int k_poll(struct k_poll_event *events, int num_events, k_timeout_t timeout);
+
+#endif /* HOST_ZEPHYR_KERNEL_H */
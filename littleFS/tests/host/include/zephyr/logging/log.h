@@ -0,0 +1,22 @@
+/* Host build of the logging API: every message goes to stderr */
+
+#ifndef HOST_ZEPHYR_LOGGING_LOG_H
+#define HOST_ZEPHYR_LOGGING_LOG_H
+
+#define LOG_LEVEL_ERR  1
+#define LOG_LEVEL_WRN  2
+#define LOG_LEVEL_INF  3
+#define LOG_LEVEL_DBG  4
+
+void host_log(const char *module, char level, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define LOG_MODULE_REGISTER(name, level) \
+    static const char *const host_log_module __attribute__((unused)) = #name
+
+#define LOG_ERR(...)   host_log(host_log_module, 'E', __VA_ARGS__)
+#define LOG_WRN(...)   host_log(host_log_module, 'W', __VA_ARGS__)
+#define LOG_INF(...)   host_log(host_log_module, 'I', __VA_ARGS__)
+#define LOG_DBG(...)   host_log(host_log_module, 'D', __VA_ARGS__)
+
+#endif /* HOST_ZEPHYR_LOGGING_LOG_H */
@@ -0,0 +1,6 @@
+/* Host build: no device power management (CONFIG_PM_DEVICE is not set) */
+
+#ifndef HOST_ZEPHYR_PM_DEVICE_H
+#define HOST_ZEPHYR_PM_DEVICE_H
+
+#endif /* HOST_ZEPHYR_PM_DEVICE_H */
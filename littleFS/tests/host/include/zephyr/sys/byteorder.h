@@ -0,0 +1,31 @@
+/* Host build of the Zephyr byte order helpers used by nor_flash.c */
+
+#ifndef HOST_ZEPHYR_SYS_BYTEORDER_H
+#define HOST_ZEPHYR_SYS_BYTEORDER_H
+
+#include <stdint.h>
+
+static inline uint32_t sys_get_le24(const uint8_t src[3])
+{
+    return (uint32_t)src[0] | ((uint32_t)src[1] << 8) | ((uint32_t)src[2] << 16);
+}
+
+static inline uint32_t sys_get_le32(const uint8_t src[4])
+{
+    return sys_get_le24(src) | ((uint32_t)src[3] << 24);
+}
+
+static inline void sys_put_be24(uint32_t val, uint8_t dst[3])
+{
+    dst[0] = val >> 16;
+    dst[1] = val >> 8;
+    dst[2] = val;
+}
+
+static inline void sys_put_be32(uint32_t val, uint8_t dst[4])
+{
+    dst[0] = val >> 24;
+    sys_put_be24(val, &dst[1]);
+}
+
+#endif /* HOST_ZEPHYR_SYS_BYTEORDER_H */
@@ -0,0 +1,11 @@
+/* Host build of the Zephyr time conversion helpers */
+
+#ifndef HOST_ZEPHYR_SYS_TIMEUTIL_H
+#define HOST_ZEPHYR_SYS_TIMEUTIL_H
+
+#include <stdint.h>
+#include <time.h>
+
+int64_t timeutil_timegm64(const struct tm *tm);
+
+#endif /* HOST_ZEPHYR_SYS_TIMEUTIL_H */
@@ -0,0 +1,16 @@
+/* Host build of the timing API, on the virtual clock (1 cycle = 1ns) */
+
+#ifndef HOST_ZEPHYR_TIMING_TIMING_H
+#define HOST_ZEPHYR_TIMING_TIMING_H
+
+#include <stdint.h>
+
+typedef uint64_t timing_t;
+
+void timing_init(void);
+void timing_start(void);
+timing_t timing_counter_get(void);
+uint64_t timing_cycles_get(volatile timing_t *const start, volatile timing_t *const end);
+uint64_t timing_cycles_to_ns(uint64_t cycles);
+
+#endif /* HOST_ZEPHYR_TIMING_TIMING_H */
@@ -0,0 +1,361 @@
+/*
+ * RAM-backed MX25L NOR flash model - see mx25l_model.h
+ */
+
+#include "mx25l_model.h"
+#include "host.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MX25L_PAGE_SIZE    256
+#define MX25L_SECTOR_SIZE  4096
+
+#define SR_WIP             0x01
+#define SR_WEL             0x02
+#define SCUR_ESB           0x08
+
+/* MX25L25645G typical cycle times; tCE is for its 32MB */
+#ifndef MX25L_TPP_US
+#define MX25L_TPP_US       250
+#endif
+#ifndef MX25L_TSE_US
+#define MX25L_TSE_US       30000
+#endif
+#ifndef MX25L_TBE32_US
+#define MX25L_TBE32_US     180000
+#endif
+#ifndef MX25L_TBE_US
+#define MX25L_TBE_US       380000
+#endif
+#ifndef MX25L_TCE_MS
+#define MX25L_TCE_MS       110000
+#endif
+#ifndef MX25L_TESL_US
+#define MX25L_TESL_US      20
+#endif
+#ifndef MX25L_TERS_US
+#define MX25L_TERS_US      100
+#endif
+/* 1-4-4 reads at 32MHz on QSPI */
+#ifndef MX25L_READ_MBPS
+#define MX25L_READ_MBPS    16
+#endif
+
+struct mx25l mx25l_flash1, mx25l_flash2;
+
+/* SFDP image: header, one parameter header pointing at the BFPT at 0x30 */
+static const uint8_t mx25l_sfdp[] = {
+    'S', 'F', 'D', 'P', 0x06, 0x01, 0x00, 0xFF,
+    0x00, 0x06, 0x01, 0x10, 0x30, 0x00, 0x00, 0xFF,
+    [0x30] = 0xE5, 0x20, 0xF3, 0xFF,     /* DW1: 1-1-4 and 1-4-4 reads supported */
+};
+
+static void mx25l_setup(struct mx25l *m, size_t size, uint32_t jedec_id)
+{
+    free(m->mem);
+    free(m->erase_counts);
+    memset(m, 0, sizeof(*m));
+    m->mem = malloc(size);
+    m->erase_counts = calloc(size / MX25L_SECTOR_SIZE, sizeof(m->erase_counts[0]));
+    if (m->mem == NULL || m->erase_counts == NULL) {
+        fprintf(stderr, "mx25l: out of memory for %zu bytes\n", size);
+        abort();
+    }
+    memset(m->mem, 0xFF, size);
+    m->size = size;
+    m->jedec_id = jedec_id;
+    m->cut_budget = MX25L_NO_FAULT;
+    m->fail_progs = MX25L_NO_FAULT;
+    m->timing = (struct mx25l_timing){
+        .pp_us = MX25L_TPP_US,
+        .se_us = MX25L_TSE_US,
+        .be32_us = MX25L_TBE32_US,
+        .be_us = MX25L_TBE_US,
+        .ce_ms = (uint32_t)((uint64_t)MX25L_TCE_MS * size / (32 * 1024 * 1024)),
+        .read_mbps = MX25L_READ_MBPS,
+        .esl_us = MX25L_TESL_US,
+        .ers_us = MX25L_TERS_US,
+    };
+}
+
+void mx25l_init(size_t flash1_size, uint32_t flash1_id, size_t flash2_size, uint32_t flash2_id)
+{
+    mx25l_setup(&mx25l_flash1, flash1_size, flash1_id);
+    mx25l_setup(&mx25l_flash2, flash2_size, flash2_id);
+}
+
+void mx25l_power_cycle(struct mx25l *m)
+{
+    m->wel = false;
+    m->busy_until_us = 0;
+    m->erasing = false;
+    m->suspended = false;
+    m->deep_power_down = false;
+    m->cut_budget = MX25L_NO_FAULT;
+    m->power_lost = false;
+    m->fail_progs = MX25L_NO_FAULT;
+    m->on_prog = NULL;
+    m->on_cut = NULL;
+}
+
+int mx25l_read_jedec_id(const struct mx25l *m, uint8_t *id)
+{
+    for (int i = 0; i < 3; i++) {
+        id[i] = m->floating ? 0xFF : m->jedec_id >> (8 * (2 - i));
+    }
+    return 0;
+}
+
+int mx25l_read_sfdp(const struct mx25l *m, uint32_t addr, uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        size_t a = addr + i;
+        buf[i] = (!m->floating && a < sizeof(mx25l_sfdp)) ? mx25l_sfdp[a] : 0xFF;
+    }
+    return 0;
+}
+
+bool mx25l_busy(const struct mx25l *m)
+{
+    return host_time_us() < m->busy_until_us;
+}
+
+/* Sector erases for spans the erase commands don't cover */
+static int64_t erase_time_us(const struct mx25l *m, size_t len)
+{
+    if (len == m->size) return (int64_t)m->timing.ce_ms * 1000;
+    if (len == 65536) return m->timing.be_us;
+    if (len == 32768) return m->timing.be32_us;
+    return (int64_t)m->timing.se_us * (len / MX25L_SECTOR_SIZE);
+}
+
+int mx25l_program(struct mx25l *m, uint32_t addr, const uint8_t *data, size_t len)
+{
+    if (addr > m->size || len > m->size - addr) return -EINVAL;
+    if (m->fail_progs == 0) {
+        m->fail_progs = MX25L_NO_FAULT;
+        return -EIO;
+    }
+    if (m->fail_progs > 0) m->fail_progs--;
+    if (m->power_lost) return 0;
+
+    m->progs++;
+    m->erasing = false;
+    size_t pages = ((addr % MX25L_PAGE_SIZE) + len + MX25L_PAGE_SIZE - 1) / MX25L_PAGE_SIZE;
+    m->busy_until_us = host_time_us() + (int64_t)m->timing.pp_us * pages;
+    for (size_t i = 0; i < len; i++) {
+        if (m->cut_budget == 0) {
+            m->power_lost = true;
+            if (m->on_cut) m->on_cut(m, addr);
+            return 0;
+        }
+        if (m->cut_budget > 0) m->cut_budget--;
+        m->mem[addr + i] &= data[i];
+    }
+    if (m->on_prog) m->on_prog(m, addr, len);
+    return 0;
+}
+
+int mx25l_erase(struct mx25l *m, uint32_t addr, size_t len)
+{
+    if ((addr % MX25L_SECTOR_SIZE) != 0 || (len % MX25L_SECTOR_SIZE) != 0) return -EINVAL;
+    if (addr > m->size || len > m->size - addr) return -EINVAL;
+    if (m->power_lost) return 0;
+
+    m->erases += len / MX25L_SECTOR_SIZE;
+    for (size_t i = 0; i < len / MX25L_SECTOR_SIZE; i++) {
+        m->erase_counts[addr / MX25L_SECTOR_SIZE + i]++;
+    }
+    m->erasing = (len != m->size);
+    m->busy_until_us = host_time_us() + erase_time_us(m, len);
+    memset(&m->mem[addr], 0xFF, len);
+    return 0;
+}
+
+/*============================================================================
+ * SPI command decoder
+ *============================================================================*/
+
+static void bad_cmd(struct mx25l *m, uint8_t op, const char *why)
+{
+    fprintf(stderr, "mx25l: command 0x%02X %s\n", op, why);
+    m->bad_cmds++;
+}
+
+/* B0: an erase stops after tESL; one that already finished has nothing to
+ * suspend, and ESB stays clear */
+static void spi_suspend(struct mx25l *m, bool busy)
+{
+    int64_t now = host_time_us();
+
+    if (m->suspended || !busy) return;
+    if (!m->erasing) {
+        bad_cmd(m, 0xB0, "during a program");
+        return;
+    }
+    if (now - m->resumed_at_us < m->timing.ers_us) bad_cmd(m, 0xB0, "within tERS of the resume");
+    m->suspended = true;
+    m->suspended_left_us = m->busy_until_us - now;
+    m->busy_until_us = now + m->timing.esl_us;
+    m->suspends++;
+}
+
+static void spi_resume(struct mx25l *m)
+{
+    if (!m->suspended) return;
+    m->suspended = false;
+    m->resumed_at_us = host_time_us();
+    m->busy_until_us = m->resumed_at_us + m->suspended_left_us;
+}
+
+static uint32_t spi_addr(const uint8_t *mosi, size_t n)
+{
+    uint32_t addr = 0;
+    for (size_t i = 0; i < n; i++) {
+        addr = (addr << 8) | mosi[1 + i];
+    }
+    return addr;
+}
+
+/* Page program: data past the page end wraps to the page start */
+static int spi_page_program(struct mx25l *m, uint32_t addr, const uint8_t *data, size_t len)
+{
+    uint32_t page = addr & ~(uint32_t)(MX25L_PAGE_SIZE - 1);
+    uint32_t off = addr - page;
+
+    if (len > MX25L_PAGE_SIZE) {
+        data += len - MX25L_PAGE_SIZE;
+        off = (off + len - MX25L_PAGE_SIZE) % MX25L_PAGE_SIZE;
+        len = MX25L_PAGE_SIZE;
+    }
+    size_t first = (off + len > MX25L_PAGE_SIZE) ? MX25L_PAGE_SIZE - off : len;
+    int ret = mx25l_program(m, page + off, data, first);
+    if (ret == 0 && first < len) {
+        ret = mx25l_program(m, page, data + first, len - first);
+    }
+    return ret;
+}
+
+int mx25l_spi_xfer(struct mx25l *m, const uint8_t *mosi, size_t mosi_len, uint8_t *miso, size_t len)
+{
+    uint8_t op = mosi[0];
+    bool busy = mx25l_busy(m);
+    uint8_t status = (busy ? SR_WIP : 0) | (m->wel ? SR_WEL : 0);
+    size_t addr_len = 0, dummy = 0;
+    int ret = 0;
+
+    memset(miso, 0xFF, len);
+
+    switch (op) {
+    case 0x03: case 0x02: case 0x20: case 0x52: case 0xD8:
+        addr_len = 3;
+        break;
+    case 0x0B: case 0x5A:
+        addr_len = 3;
+        dummy = 1;
+        break;
+    case 0x13: case 0x12: case 0x21: case 0x5C: case 0xDC:
+        addr_len = 4;
+        break;
+    case 0x0C:
+        addr_len = 4;
+        dummy = 1;
+        break;
+    }
+    if (mosi_len < 1 + addr_len + dummy) {
+        bad_cmd(m, op, "cut short");
+        return 0;
+    }
+    uint32_t addr = spi_addr(mosi, addr_len);
+    size_t data_at = 1 + addr_len + dummy;
+
+    if (m->on_cmd) m->on_cmd(m, op, addr, addr_len);
+    if (m->floating) return 0;
+    if (m->deep_power_down && op != 0xAB) {
+        m->bad_cmds++;
+        return 0;
+    }
+    if (busy && op != 0x05 && op != 0x2B && op != 0xB0 && op != 0x66 && op != 0x99) {
+        bad_cmd(m, op, "while busy");
+        return 0;
+    }
+
+    switch (op) {
+    case 0x05:  /* RDSR */
+        memset(miso + 1, status, len - 1);
+        break;
+    case 0x2B:  /* RDSCUR */
+        memset(miso + 1, m->suspended ? SCUR_ESB : 0x00, len - 1);
+        break;
+    case 0x9F:  /* RDID */
+        if (len > 1) {
+            uint8_t id[3];
+            mx25l_read_jedec_id(m, id);
+            memcpy(miso + 1, id, (len - 1 < sizeof(id)) ? len - 1 : sizeof(id));
+        }
+        break;
+    case 0x06:
+        m->wel = true;
+        break;
+    case 0x04:
+        m->wel = false;
+        break;
+    case 0xAB:
+        m->deep_power_down = false;
+        break;
+    case 0xB9:
+        m->deep_power_down = true;
+        break;
+    case 0xB0:
+        spi_suspend(m, busy);
+        break;
+    case 0x30:
+        spi_resume(m);
+        break;
+    case 0x66:
+        break;
+    case 0x99:
+        m->wel = false;
+        m->busy_until_us = 0;
+        m->erasing = false;
+        m->suspended = false;
+        break;
+    case 0x03: case 0x13: case 0x0B: case 0x0C:
+        for (size_t i = data_at; i < len; i++) {
+            miso[i] = m->mem[(addr + (i - data_at)) % m->size];
+        }
+        break;
+    case 0x5A:
+        if (len > data_at) mx25l_read_sfdp(m, addr, miso + data_at, len - data_at);
+        break;
+    case 0x02: case 0x12:
+    case 0x20: case 0x21: case 0x52: case 0x5C: case 0xD8: case 0xDC:
+    case 0x60: case 0xC7:
+        if (!m->wel) {
+            bad_cmd(m, op, "without WREN");
+            break;
+        }
+        if (m->suspended) {
+            bad_cmd(m, op, "while an erase is suspended");
+            m->wel = false;
+            break;
+        }
+        if (op == 0x02 || op == 0x12) {
+            ret = spi_page_program(m, addr % m->size, mosi + data_at, mosi_len - data_at);
+        } else if (op == 0x60 || op == 0xC7) {
+            ret = mx25l_erase(m, 0, m->size);
+        } else {
+            size_t span = (op == 0x20 || op == 0x21) ? 4096 : (op == 0x52 || op == 0x5C) ? 32768 : 65536;
+            ret = mx25l_erase(m, (addr % m->size) & ~(uint32_t)(span - 1), span);
+        }
+        m->wel = false;
+        break;
+    default:
+        bad_cmd(m, op, "unknown");
+        break;
+    }
+    return ret;
+}
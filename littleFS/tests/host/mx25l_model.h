@@ -0,0 +1,121 @@
+/*
+ * RAM-backed MX25L NOR flash model
+ *
+ * Behaves like the part where it matters to the driver: erase sets bytes to
+ * 0xFF, program can only clear bits (new = old & data), page programs wrap
+ * within their 256-byte page, and program/erase need WREN first. FLASH1 is
+ * driven through its SPI command set (spi_transceive() on host_device_spi1),
+ * FLASH2 through the flash API (host_device_mx25l51245g), as on the board.
+ *
+ * Timing: program and erase keep the chip busy (WIP set) for their cycle
+ * time on the virtual clock, tPP per page, tSE/tBE32/tBE per sector or block
+ * and tCE for the chip. The defaults are the MX25L25645G typical figures and
+ * each can be set at configure time (MX25L_TPP_US and friends, see
+ * CMakeLists.txt) or per chip through struct mx25l_timing. The bus time of
+ * a transfer is charged by the shim (host_kernel.c): the SPI clock for
+ * FLASH1, read_mbps for FLASH2.
+ *
+ * Erase suspend (FLASH1): B0 during a sector or block erase suspends it
+ * after tESL, sets ESB in the security register (RDSCUR) and lets reads
+ * through; 30 resumes it for the time it had left. A suspend sooner than
+ * tERS after a resume, during a program, or a program or erase while
+ * suspended counts as a bad command.
+ *
+ * Faults for power-loss tests:
+ *  - cut_budget: bytes that may still be programmed before power is lost.
+ *    The byte that exhausts it and every program or erase after it are
+ *    dropped while the calls still report success (the CPU dies with the
+ *    rail; the test then "reboots" and checks what is on flash). on_cut is
+ *    called at that moment with the address of the program being cut.
+ *  - fail_progs: program operations to let through before one fails with
+ *    -EIO, leaving flash untouched.
+ *  - floating: the chip no longer answers, as with a dead part or a broken
+ *    line; reads clock in 0xFF and commands are ignored. FLASH2's driver
+ *    checks the JEDEC ID at init, so the device is then not ready.
+ *
+ * erase_counts holds every erase each 4KB sector has actually been through,
+ * the reference for the driver's own wear counts.
+ *
+ * on_cmd sees every SPI command (FLASH1) with its decoded address, so a
+ * test can trace the bus or change the chip's state at a given command.
+ *
+ * timing.ready_delay_us is added to device_is_ready() on the chip's bus
+ * device, standing in for a slow controller or power-up in bring-up benches.
+ */
+
+#ifndef MX25L_MODEL_H
+#define MX25L_MODEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MX25L_NO_FAULT  (-1)
+
+struct mx25l_timing {
+    uint32_t pp_us;              /* tPP, page program */
+    uint32_t se_us;              /* tSE, 4KB sector erase */
+    uint32_t be32_us;            /* tBE32, 32KB block erase */
+    uint32_t be_us;              /* tBE, 64KB block erase */
+    uint32_t ce_ms;              /* tCE, chip erase (scaled to the chip size) */
+    uint32_t read_mbps;          /* Flash API transfers, MB/s (= bytes per us) */
+    uint32_t esl_us;             /* tESL, erase suspend latency */
+    uint32_t ers_us;             /* tERS, resume to next suspend */
+    uint32_t ready_delay_us;     /* Added to device_is_ready() */
+};
+
+struct mx25l {
+    uint8_t *mem;
+    size_t size;
+    uint32_t jedec_id;
+
+    /* SPI state (FLASH1) */
+    bool wel;
+    bool deep_power_down;
+
+    /* Program/erase in progress until this time on the virtual clock */
+    struct mx25l_timing timing;
+    int64_t busy_until_us;
+    bool erasing;                /* The busy cycle is a sector or block erase */
+    bool suspended;              /* ESB */
+    int64_t suspended_left_us;   /* Erase time left when it was suspended */
+    int64_t resumed_at_us;
+
+    /* Fault injection */
+    long cut_budget;             /* MX25L_NO_FAULT, or bytes left before the cut */
+    bool power_lost;
+    long fail_progs;             /* MX25L_NO_FAULT, or programs left before an -EIO */
+    bool floating;
+    void (*on_prog)(struct mx25l *m, uint32_t addr, size_t len);
+    void (*on_cut)(struct mx25l *m, uint32_t addr);
+    void (*on_cmd)(struct mx25l *m, uint8_t op, uint32_t addr, size_t addr_len);
+
+    /* Counters */
+    uint32_t progs, erases, suspends, bad_cmds;
+    uint32_t *erase_counts;      /* Per 4KB sector */
+};
+
+extern struct mx25l mx25l_flash1, mx25l_flash2;
+
+/* Allocate both chips blank (all 0xFF) at the sizes nor_flash.h selects */
+void mx25l_init(size_t flash1_size, uint32_t flash1_id, size_t flash2_size, uint32_t flash2_id);
+
+/* Power comes back: faults cleared, contents kept */
+void mx25l_power_cycle(struct mx25l *m);
+
+/* WIP: a program or erase cycle has not finished yet */
+bool mx25l_busy(const struct mx25l *m);
+
+/* Program and erase as the chip does them, subject to the faults above;
+ * each starts the busy time of its cycle */
+int mx25l_program(struct mx25l *m, uint32_t addr, const uint8_t *data, size_t len);
+int mx25l_erase(struct mx25l *m, uint32_t addr, size_t len);
+
+/* JEDEC ID and SFDP as the flash API's JESD216 calls return them */
+int mx25l_read_jedec_id(const struct mx25l *m, uint8_t *id);
+int mx25l_read_sfdp(const struct mx25l *m, uint32_t addr, uint8_t *buf, size_t len);
+
+/* SPI transaction, one chip select */
+int mx25l_spi_xfer(struct mx25l *m, const uint8_t *mosi, size_t mosi_len, uint8_t *miso, size_t len);
+
+#endif /* MX25L_MODEL_H */
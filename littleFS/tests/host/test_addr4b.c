@@ -0,0 +1,128 @@
+/*
+ * Parts above 16MB: every addressed command is its 4-byte opcode with four
+ * address bytes, and data lands on both sides of the 16MB line without
+ * wrapping onto the bottom of the chip.
+ */
+
+#include "host_nor_flash.h"
+
+#define LINE      0x1000000U     /* First address a 3-byte command cannot reach */
+#define READ_4B   ((FLASH1_READ_MODE == FLASH1_READ_MODE_FAST) ? 0x0C : 0x13)
+
+struct cmd {
+    uint8_t op;
+    uint32_t addr;
+    size_t addr_len;
+};
+
+static struct cmd trace[32];
+static size_t traced;
+
+/* Everything but status polls and WREN */
+static void trace_cmd(struct mx25l *m, uint8_t op, uint32_t addr, size_t addr_len)
+{
+    if (op == 0x05 || op == 0x06) return;
+    REQUIRE(traced < ARRAY_SIZE(trace));
+    trace[traced++] = (struct cmd){op, addr, addr_len};
+}
+
+static void expect_cmds(const struct cmd *want, size_t count)
+{
+    CHECK_EQ(traced, count);
+    for (size_t i = 0; i < MIN(traced, count); i++) {
+        CHECK_EQ(trace[i].op, want[i].op);
+        CHECK_EQ(trace[i].addr, want[i].addr);
+        CHECK_EQ(trace[i].addr_len, want[i].addr_len);
+    }
+    traced = 0;
+}
+
+static bool erased(uint32_t addr, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (mx25l_flash1.mem[addr + i] != 0xFF) return false;
+    }
+    return true;
+}
+
+static void test_raw_across_16mb(void)
+{
+    static uint8_t data[1024], back[1024], low[FLASH_BLOCK_SIZE_64K];
+
+    host_boot_blank();
+    /* Where a 3-byte address would wrap to; holds the superblock */
+    memcpy(low, mx25l_flash1.mem, sizeof(low));
+    mx25l_flash1.on_cmd = trace_cmd;
+
+    REQUIRE(flash1_erase_range(LINE - FLASH_SECTOR_SIZE, 2 * FLASH_SECTOR_SIZE) == 0);
+    expect_cmds((const struct cmd[]){
+        {0x21, LINE - FLASH_SECTOR_SIZE, 4},
+        {0x21, LINE, 4},
+    }, 2);
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 7 + 1);
+    }
+    REQUIRE(flash1_prog_data(LINE - 512, data, sizeof(data)) == 0);
+    expect_cmds((const struct cmd[]){
+        {0x12, LINE - 512, 4},
+        {0x12, LINE - 256, 4},
+        {0x12, LINE, 4},
+        {0x12, LINE + 256, 4},
+    }, 4);
+    CHECK(memcmp(&mx25l_flash1.mem[LINE - 512], data, sizeof(data)) == 0);
+
+    REQUIRE(flash1_read_data(LINE - 512, back, sizeof(back)) == 0);
+    expect_cmds((const struct cmd[]){{READ_4B, LINE - 512, 4}}, 1);
+    CHECK(memcmp(back, data, sizeof(back)) == 0);
+
+    /* 32KB block below the line, 64KB block above it */
+    REQUIRE(flash1_erase_range(LINE - FLASH_BLOCK_SIZE_32K, FLASH_BLOCK_SIZE_32K + FLASH_BLOCK_SIZE_64K) == 0);
+    expect_cmds((const struct cmd[]){
+        {0x5C, LINE - FLASH_BLOCK_SIZE_32K, 4},
+        {0xDC, LINE, 4},
+    }, 2);
+    CHECK(erased(LINE - FLASH_BLOCK_SIZE_32K, FLASH_BLOCK_SIZE_32K + FLASH_BLOCK_SIZE_64K));
+
+    CHECK(memcmp(mx25l_flash1.mem, low, sizeof(low)) == 0);
+    host_check_bus();
+}
+
+/* LittleFS block callbacks for a block past the line */
+static void test_lfs_above_16mb(void)
+{
+    const lfs_block_t block = LINE / FLASH_SECTOR_SIZE + 1;
+    const uint32_t addr = block * FLASH_SECTOR_SIZE;
+    static uint8_t data[FLASH_PAGE_SIZE], back[FLASH_PAGE_SIZE];
+
+    host_boot_blank();
+    REQUIRE(block < lfs_cfg1.block_count);
+    memset(data, 0x5A, sizeof(data));
+    mx25l_flash1.on_cmd = trace_cmd;
+
+    k_mutex_lock(&lfs1_lock, K_FOREVER);
+    REQUIRE(lfs_cfg1.erase(&lfs_cfg1, block) == 0);
+    REQUIRE(lfs_cfg1.prog(&lfs_cfg1, block, FLASH_PAGE_SIZE, data, sizeof(data)) == 0);
+    REQUIRE(lfs_cfg1.read(&lfs_cfg1, block, FLASH_PAGE_SIZE, back, sizeof(back)) == 0);
+    k_mutex_unlock(&lfs1_lock);
+
+    expect_cmds((const struct cmd[]){
+        {0x21, addr, 4},
+        {0x12, addr + FLASH_PAGE_SIZE, 4},
+        {READ_4B, addr + FLASH_PAGE_SIZE, 4},
+    }, 3);
+    CHECK(memcmp(back, data, sizeof(back)) == 0);
+    CHECK(memcmp(&mx25l_flash1.mem[addr + FLASH_PAGE_SIZE], data, sizeof(data)) == 0);
+    CHECK(erased(addr, FLASH_PAGE_SIZE));
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"raw_across_16mb", test_raw_across_16mb},
+    {"lfs_above_16mb", test_lfs_above_16mb},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
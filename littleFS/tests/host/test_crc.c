@@ -0,0 +1,159 @@
+/*
+ * lfs_crc() for the LFS_CRC_SLICES width this is built with: the slice
+ * tables are rebuilt from the polynomial, and results are compared with a
+ * bitwise CRC over every alignment, length and split point that matters.
+ * The throughput case times both on the host CPU.
+ */
+
+#include <time.h>
+
+#include "lfs_util.c"
+
+#include "host.h"
+
+#define CRC_POLY 0xEDB88320
+
+/* One bit at a time, reflected, no final xor - what LittleFS computes */
+static uint32_t crc_bitwise(uint32_t crc, const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? CRC_POLY : 0);
+        }
+    }
+    return crc;
+}
+
+static uint8_t pattern[1024 + 16];
+
+static void fill_pattern(void)
+{
+    uint32_t x = 0x12345678;
+    for (size_t i = 0; i < sizeof(pattern); i++) {
+        x = x * 1103515245 + 12345;
+        pattern[i] = x >> 16;
+    }
+}
+
+#if LFS_CRC_SLICES > 1
+/* stable[k][i] is the CRC of byte i followed by k zero bytes */
+static void test_table(void)
+{
+    for (int i = 0; i < 256; i++) {
+        uint8_t byte = i;
+        uint32_t crc = crc_bitwise(0, &byte, 1);
+
+        CHECK_EQ(stable[0][i], crc);
+        for (int k = 1; k < LFS_CRC_SLICES; k++) {
+            crc = (crc >> 8) ^ stable[0][crc & 0xff];
+            if (stable[k][i] != crc) {
+                fprintf(stderr, "stable[%d][%d] = 0x%08x, expected 0x%08x\n", k, i, stable[k][i], crc);
+                host_failures++;
+            }
+        }
+    }
+}
+#endif
+
+/* The standard CRC-32 check value, with the usual init and final xor */
+static void test_check_value(void)
+{
+    CHECK_EQ(lfs_crc(0xFFFFFFFF, "123456789", 9) ^ 0xFFFFFFFF, 0xCBF43926);
+    CHECK_EQ(lfs_crc(0xFFFFFFFF, "", 0), 0xFFFFFFFF);
+}
+
+/* Every start alignment and the lengths around the slice width */
+static void test_reference(void)
+{
+    fill_pattern();
+    for (size_t align = 0; align < 16; align++) {
+        for (size_t len = 0; len <= 1024; len += (len < 64) ? 1 : 61) {
+            const uint8_t *p = &pattern[align];
+            uint32_t want = crc_bitwise(0xFFFFFFFF, p, len);
+            uint32_t got = lfs_crc(0xFFFFFFFF, p, len);
+            if (got != want) {
+                fprintf(stderr, "align %zu len %zu: 0x%08x, expected 0x%08x\n", align, len, got, want);
+                host_failures++;
+            }
+        }
+    }
+}
+
+/* Chaining calls at any split gives the same CRC as one call */
+static void test_chained(void)
+{
+    fill_pattern();
+    uint32_t whole = lfs_crc(0xFFFFFFFF, pattern, 257);
+
+    for (size_t split = 0; split <= 257; split++) {
+        uint32_t crc = lfs_crc(0xFFFFFFFF, pattern, split);
+        crc = lfs_crc(crc, &pattern[split], 257 - split);
+        if (crc != whole) {
+            fprintf(stderr, "split at %zu: 0x%08x, expected 0x%08x\n", split, crc, whole);
+            host_failures++;
+        }
+    }
+}
+
+static int64_t cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* MB/s of crc over a 64KB buffer, best of 5 runs of 32 passes */
+static double crc_rate(uint32_t (*crc)(uint32_t, const void *, size_t), uint32_t *result)
+{
+    static uint8_t buf[64 * 1024];
+    int64_t best = INT64_MAX;
+
+    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = pattern[i % sizeof(pattern)];
+    for (int run = 0; run < 5; run++) {
+        uint32_t c = 0xFFFFFFFF;
+        int64_t start = cpu_ns();
+        for (int p = 0; p < 32; p++) c = crc(c, buf, sizeof(buf));
+        int64_t ns = cpu_ns() - start;
+        if (ns < best) best = ns;
+        *result = c;
+    }
+    return (double)sizeof(buf) * 32 * 1000.0 / (double)(best > 0 ? best : 1);
+}
+
+static uint32_t bitwise_crc(uint32_t crc, const void *data, size_t size)
+{
+    return crc_bitwise(crc, data, size);
+}
+
+/* Host CPU MB/s of lfs_crc() and of the bitwise reference */
+static void test_throughput(void)
+{
+    uint32_t got, want;
+
+    fill_pattern();
+    double rate = crc_rate(lfs_crc, &got);
+    double ref = crc_rate(bitwise_crc, &want);
+    CHECK_EQ(got, want);
+
+    host_bench("lfs_crc", rate, "MB/s");
+    host_bench("bitwise", ref, "MB/s");
+    host_bench("speedup", rate / ref, "x");
+    CHECK(rate > ref);
+}
+
+static const struct host_test tests[] = {
+#if LFS_CRC_SLICES > 1
+    {"table", test_table},
+#endif
+    {"check_value", test_check_value},
+    {"reference", test_reference},
+    {"chained", test_chained},
+    {"throughput", test_throughput},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, sizeof(tests) / sizeof(tests[0]));
+}
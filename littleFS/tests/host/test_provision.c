@@ -0,0 +1,92 @@
+/*
+ * NOR_FLASH_FORMAT_BLANK: a new chip is formatted at boot, a chip that
+ * stopped answering is not, although both read all 0xFF.
+ */
+
+#include "host_nor_flash.h"
+
+static uint32_t resets;
+
+static void blank_chips(void)
+{
+    mx25l_init(FLASH1_CHIP_SIZE_BYTES, FLASH1_CHIP_JEDEC_ID, FLASH2_CHIP_SIZE_BYTES, FLASH2_CHIP_JEDEC_ID);
+}
+
+static void test_blank_chips(void)
+{
+    char buf[6];
+
+    blank_chips();
+    CHECK_EQ(nor_flash_system_init(), 0);
+    CHECK(lfs1_mounted && lfs2_mounted);
+    REQUIRE(nor_flash_write_file(FLASH1, "a", "hello", 5) == 0);
+    CHECK_EQ(nor_flash_read_file(FLASH1, "a", buf, sizeof(buf)), 5);
+    host_check_bus();
+}
+
+/* The chip answers its ID at init, then the bus goes dead at the first read */
+static void drop_off_bus(struct mx25l *m, uint8_t op, uint32_t addr, size_t addr_len)
+{
+    if (op == 0x03 || op == 0x0B) m->floating = true;
+    if (op == 0x66) resets++;
+}
+
+static void test_floating_bus(void)
+{
+    blank_chips();
+    mx25l_flash1.on_cmd = drop_off_bus;
+    CHECK_EQ(nor_flash_system_init(), -EIO);
+
+    /* One bus reset in the mount stage, which fails and ends it, and one
+     * before the format, which fails too */
+    CHECK_EQ(resets, 2);
+    CHECK(!lfs1_mounted);
+    CHECK_EQ(nor_flash_init_status(FLASH1), -EIO);
+    CHECK_EQ(mx25l_flash1.progs, 0);
+    CHECK_EQ(mx25l_flash1.erases, 0);
+
+    /* The other device is not held up */
+    CHECK(lfs2_mounted);
+    CHECK_EQ(nor_flash_init_status(FLASH2), 0);
+}
+
+/* Answers RDID but has no SFDP table: not the part it should be */
+static void hide_sfdp(struct mx25l *m, uint8_t op, uint32_t addr, size_t addr_len)
+{
+    m->floating = (op == 0x5A);
+}
+
+static void test_no_sfdp(void)
+{
+    blank_chips();
+    mx25l_flash1.on_cmd = hide_sfdp;
+    CHECK_EQ(nor_flash_system_init(), -EIO);
+    CHECK(!lfs1_mounted);
+    CHECK_EQ(mx25l_flash1.progs, 0);
+    CHECK_EQ(mx25l_flash1.erases, 0);
+    CHECK(lfs2_mounted);
+}
+
+/* FLASH2 missing at power-up: its driver never becomes ready */
+static void test_flash2_missing(void)
+{
+    blank_chips();
+    mx25l_flash2.floating = true;
+    CHECK_EQ(nor_flash_system_init(), -EIO);
+    CHECK(!lfs2_mounted);
+    CHECK_EQ(mx25l_flash2.progs, 0);
+    CHECK_EQ(mx25l_flash2.erases, 0);
+    CHECK(lfs1_mounted);
+}
+
+static const struct host_test tests[] = {
+    {"blank_chips", test_blank_chips},
+    {"floating_bus", test_floating_bus},
+    {"no_sfdp", test_no_sfdp},
+    {"flash2_missing", test_flash2_missing},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
@@ -0,0 +1,266 @@
+/*
+ * Raw recording log: what recovery finds after a power cut at any byte of
+ * an append, and reading back by position and by time, wrap included.
+ */
+
+#include "host_nor_flash.h"
+
+#define REC_HDR  sizeof(struct rawlog_rec_hdr)
+#define SEG_HDR  sizeof(struct rawlog_seg_hdr)
+
+static uint8_t buf[RAWLOG_SEG_SIZE];
+
+/* Payload for record id; never 0xFF, so a dropped byte always shows */
+static void fill(uint8_t *data, size_t len, uint32_t id)
+{
+    for (size_t i = 0; i < len; i++) {
+        data[i] = (uint8_t)(i * 13 + id * 7) & 0x7F;
+    }
+}
+
+static void append(uint32_t id, size_t len, uint32_t time)
+{
+    static uint8_t data[RAWLOG_SEG_SIZE];
+
+    fill(data, len, id);
+    REQUIRE(nor_flash_rawlog_append(data, len, time) == 0);
+}
+
+/* Read the next record and check it is record id */
+static void expect(struct nor_flash_rawlog_pos *pos, uint32_t id, size_t len, uint32_t time)
+{
+    static uint8_t want[RAWLOG_SEG_SIZE];
+    uint32_t got_time = 0;
+
+    fill(want, len, id);
+    CHECK_EQ(nor_flash_rawlog_read(pos, buf, sizeof(buf), &got_time), len);
+    CHECK_EQ(got_time, time);
+    CHECK(memcmp(buf, want, len) == 0);
+}
+
+static void expect_end(struct nor_flash_rawlog_pos *pos)
+{
+    CHECK_EQ(nor_flash_rawlog_read(pos, buf, sizeof(buf), NULL), 0);
+}
+
+/* Power back on: the RAM state is gone and init rescans the region */
+static int reboot(void)
+{
+    mx25l_power_cycle(&mx25l_flash2);
+    rawlog = (typeof(rawlog)){.head = RAWLOG_NONE};
+    return nor_flash_rawlog_recover();
+}
+
+static void test_round_trip(void)
+{
+    struct nor_flash_rawlog_pos pos;
+
+    host_boot_blank();
+    CHECK_EQ(nor_flash_rawlog_seek(0, &pos), -ENODATA);
+    for (uint32_t i = 0; i < 20; i++) {
+        append(i, 1 + i * 37, 100 + i);
+    }
+    uint32_t head = rawlog.head, head_off = rawlog.head_off;
+
+    CHECK_EQ(reboot(), 0);
+    CHECK_EQ(rawlog.head, head);
+    CHECK_EQ(rawlog.head_off, head_off);
+    CHECK_EQ(rawlog.used, 1);
+
+    REQUIRE(nor_flash_rawlog_seek(0, &pos) == 0);
+    for (uint32_t i = 0; i < 20; i++) {
+        expect(&pos, i, 1 + i * 37, 100 + i);
+    }
+    expect_end(&pos);
+
+    /* Appends after recovery go on where the last boot stopped */
+    append(20, 50, 200);
+    expect(&pos, 20, 50, 200);
+    expect_end(&pos);
+
+    /* Too small a buffer leaves pos on the record */
+    REQUIRE(nor_flash_rawlog_seek(0, &pos) == 0);
+    CHECK_EQ(nor_flash_rawlog_read(&pos, buf, 0, NULL), -EMSGSIZE);
+    expect(&pos, 0, 1, 100);
+    host_check_bus();
+}
+
+/* A record header cut after its first cut bytes no longer checks out if a
+ * byte it lost before the CRC field was not 0xFF anyway */
+static bool header_torn(uint32_t time, size_t len, long cut)
+{
+    struct rawlog_rec_hdr rec = {.time = time, .len = len, .len_inv = (uint16_t)~len};
+    const uint8_t *p = (const uint8_t *)&rec;
+
+    for (long i = cut; i < (long)offsetof(struct rawlog_rec_hdr, crc); i++) {
+        if (cut > 0 && p[i] != 0xFF) return true;
+    }
+    return false;
+}
+
+/*
+ * Power cut at every byte of an append. A torn header ends its segment and
+ * the next append opens a new one; a torn payload (or CRC field) fails the
+ * CRC and is skipped by length. Either way the records around it read back.
+ */
+static void test_torn_append(void)
+{
+    const size_t len = 40;
+    struct nor_flash_rawlog_pos pos;
+
+    host_boot_blank();
+    for (long cut = 0; cut <= (long)(REC_HDR + len); cut++) {
+        bool hdr_torn = header_torn(12, len, cut);
+
+        REQUIRE(nor_flash_rawlog_clear() == 0);
+        append(1, 100, 10);
+        append(2, 30, 11);
+
+        mx25l_flash2.cut_budget = cut;
+        append(3, len, 12);
+        bool lost = mx25l_flash2.power_lost;
+        int damaged = reboot();
+
+        if (cut == 0 || cut == REC_HDR + len) {
+            CHECK_EQ(damaged, 0);
+            CHECK_EQ(lost, cut == 0);
+        } else {
+            CHECK_EQ(damaged, 1);
+            CHECK(lost);
+        }
+        if (hdr_torn) {
+            CHECK_EQ(rawlog.head_off, RAWLOG_SEG_SIZE);
+        }
+
+        /* Recovery only walks the head segment */
+        append(4, 20, 13);
+        CHECK_EQ(reboot(), hdr_torn ? 0 : damaged);
+        CHECK_EQ(rawlog.used, hdr_torn ? 2 : 1);
+
+        REQUIRE(nor_flash_rawlog_seek(0, &pos) == 0);
+        expect(&pos, 1, 100, 10);
+        expect(&pos, 2, 30, 11);
+        if (cut == REC_HDR + len) {
+            expect(&pos, 3, len, 12);
+        } else if (cut > 0 && !hdr_torn) {
+            CHECK_EQ(nor_flash_rawlog_read(&pos, buf, sizeof(buf), NULL), -EBADMSG);
+        }
+        expect(&pos, 4, 20, 13);
+        expect_end(&pos);
+    }
+    host_check_bus();
+}
+
+/* Power cut while a new segment's header is programmed */
+static void test_torn_segment_header(void)
+{
+    const size_t fill_len = RAWLOG_SEG_SIZE - SEG_HDR - REC_HDR;
+    struct nor_flash_rawlog_pos pos;
+
+    host_boot_blank();
+    for (long cut = 0; cut < (long)SEG_HDR; cut++) {
+        REQUIRE(nor_flash_rawlog_clear() == 0);
+        append(1, fill_len, 10);
+        CHECK_EQ(rawlog.head_off, RAWLOG_SEG_SIZE);
+
+        mx25l_flash2.cut_budget = cut;
+        append(2, 20, 11);
+        CHECK_EQ(reboot(), 0);
+        CHECK_EQ(rawlog.head, 0);
+        CHECK_EQ(rawlog.used, 1);
+
+        append(3, 20, 12);
+        CHECK_EQ(rawlog.head, 1);
+        REQUIRE(nor_flash_rawlog_seek(0, &pos) == 0);
+        expect(&pos, 1, fill_len, 10);
+        expect(&pos, 3, 20, 12);
+        expect_end(&pos);
+    }
+    host_check_bus();
+}
+
+/* Data larger than a segment's room is split at the segment end */
+static void test_split(void)
+{
+    const size_t first = RAWLOG_SEG_SIZE - SEG_HDR - REC_HDR - 1000;
+    static uint8_t data[3000], want[3000];
+    struct nor_flash_rawlog_pos pos;
+
+    host_boot_blank();
+    append(1, first, 10);
+    fill(data, sizeof(data), 2);
+    REQUIRE(nor_flash_rawlog_append(data, sizeof(data), 11) == 0);
+    CHECK_EQ(rawlog.head, 1);
+    CHECK_EQ(reboot(), 0);
+
+    REQUIRE(nor_flash_rawlog_seek(0, &pos) == 0);
+    expect(&pos, 1, first, 10);
+    size_t got = 0;
+    while (got < sizeof(data)) {
+        uint32_t time = 0;
+        int n = nor_flash_rawlog_read(&pos, &want[got], sizeof(want) - got, &time);
+        REQUIRE(n > 0);
+        CHECK_EQ(time, 11);
+        got += n;
+    }
+    CHECK(memcmp(want, data, sizeof(data)) == 0);
+    expect_end(&pos);
+}
+
+/* The full ring reclaims its oldest segment; seek finds records by time */
+static void test_wrap_and_seek(void)
+{
+    const size_t len = 7268;    /* Nine records fill a segment exactly, none split */
+    const uint32_t per_seg = (RAWLOG_SEG_SIZE - SEG_HDR) / RAWLOG_REC_SIZE(len);
+    const uint32_t count = per_seg * (NOR_FLASH_RAWLOG_SEGMENTS + 2) + 3;
+    struct nor_flash_rawlog_pos pos;
+
+    REQUIRE((RAWLOG_SEG_SIZE - SEG_HDR) % RAWLOG_REC_SIZE(len) == 0);
+    host_boot_blank();
+    for (uint32_t i = 0; i < count; i++) {
+        append(i, len, 1000 + 10 * i);
+    }
+    CHECK_EQ(rawlog.used, NOR_FLASH_RAWLOG_SEGMENTS);
+    CHECK_EQ(reboot(), 0);
+    CHECK_EQ(rawlog.used, NOR_FLASH_RAWLOG_SEGMENTS);
+
+    /* Oldest kept: the first record of the segment after head */
+    uint32_t oldest = count - 3 - per_seg * (NOR_FLASH_RAWLOG_SEGMENTS - 1);
+    REQUIRE(nor_flash_rawlog_seek(0, &pos) == 0);
+    expect(&pos, oldest, len, 1000 + 10 * oldest);
+
+    /* Between two records, exactly on one, and at a segment's first one */
+    uint32_t id = oldest + per_seg + 2;
+    REQUIRE(nor_flash_rawlog_seek(1000 + 10 * id - 5, &pos) == 0);
+    expect(&pos, id, len, 1000 + 10 * id);
+    REQUIRE(nor_flash_rawlog_seek(1000 + 10 * id, &pos) == 0);
+    expect(&pos, id, len, 1000 + 10 * id);
+    id = oldest + 2 * per_seg;
+    REQUIRE(nor_flash_rawlog_seek(1000 + 10 * id - 1, &pos) == 0);
+    expect(&pos, id, len, 1000 + 10 * id);
+
+    /* Past the newest: nothing to read */
+    REQUIRE(nor_flash_rawlog_seek(1000 + 10 * count, &pos) == 0);
+    expect_end(&pos);
+
+    /* Everything from the oldest on, in order */
+    REQUIRE(nor_flash_rawlog_seek(0, &pos) == 0);
+    for (uint32_t i = oldest; i < count; i++) {
+        expect(&pos, i, len, 1000 + 10 * i);
+    }
+    expect_end(&pos);
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"round_trip", test_round_trip},
+    {"torn_append", test_torn_append},
+    {"torn_segment_header", test_torn_segment_header},
+    {"split", test_split},
+    {"wrap_and_seek", test_wrap_and_seek},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
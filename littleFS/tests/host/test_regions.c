@@ -0,0 +1,121 @@
+/*
+ * Regions the raw calls may touch: nor_flash_erase_range() and
+ * nor_flash_prog_async() take the raw region, and LittleFS blocks only
+ * while the device is not mounted. The raw log and the wear tables are the
+ * driver's own; the driver still erases them itself. The async program
+ * worker does not run here, so only what prog_async accepts is checked.
+ */
+
+#include "host_nor_flash.h"
+
+#define SECTOR  FLASH_SECTOR_SIZE
+
+static const uint8_t data[16] = "raw region data";
+
+static uint32_t raw_base(flash_device_t device)
+{
+    return ((device == FLASH1) ? FLASH1_LFS_BLOCKS : FLASH2_LFS_BLOCKS) * SECTOR;
+}
+
+static struct mx25l *chip(flash_device_t device)
+{
+    return (device == FLASH1) ? &mx25l_flash1 : &mx25l_flash2;
+}
+
+static int prog(flash_device_t device, uint32_t addr)
+{
+    return nor_flash_prog_async(device, addr, data, sizeof(data), NULL, NULL, NULL);
+}
+
+static void test_raw_region(void)
+{
+    host_boot_blank();
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        uint32_t base = raw_base(device);
+
+        chip(device)->mem[base + SECTOR] = 0;
+        CHECK_EQ(nor_flash_erase_range(device, base, 2 * SECTOR), 0);
+        CHECK_EQ(chip(device)->mem[base + SECTOR], 0xFF);
+        CHECK_EQ(prog(device, base + SECTOR), 0);
+    }
+    host_check_bus();
+}
+
+static void test_mounted_lfs(void)
+{
+    char buf[8];
+
+    host_boot_blank();
+    REQUIRE(nor_flash_write_file(FLASH1, "keep.txt", "kept", 4) == 0);
+    uint32_t erases = mx25l_flash1.erases + mx25l_flash2.erases;
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        uint32_t base = raw_base(device);
+
+        CHECK_EQ(nor_flash_erase_range(device, 0, SECTOR), -EACCES);
+        CHECK_EQ(nor_flash_erase_range(device, base - SECTOR, 2 * SECTOR), -EACCES);
+        CHECK_EQ(prog(device, 0), -EACCES);
+        CHECK_EQ(prog(device, base - 8), -EACCES);
+    }
+
+    /* Nothing reached the chips, and LittleFS is as it was */
+    CHECK_EQ(mx25l_flash1.erases + mx25l_flash2.erases, erases);
+    CHECK_EQ(nor_flash_read_file(FLASH1, "keep.txt", buf, sizeof(buf)), 4);
+    host_check_bus();
+}
+
+/* Unmounted, the LittleFS range is free for raw use, as for a reformat */
+static void test_unmounted_lfs(void)
+{
+    host_boot_blank();
+    k_mutex_lock(&lfs1_lock, K_FOREVER);
+    lfs_unmount(&lfs1);
+    lfs1_mounted = false;
+    k_mutex_unlock(&lfs1_lock);
+
+    uint32_t erases = mx25l_flash1.erase_counts[1];
+    CHECK_EQ(nor_flash_erase_range(FLASH1, 0, 2 * SECTOR), 0);
+    CHECK_EQ(mx25l_flash1.erase_counts[1], erases + 1);
+    CHECK_EQ(prog(FLASH1, 0), 0);
+
+    /* Still held to the raw region's end */
+    CHECK_EQ(nor_flash_erase_range(FLASH1, 0, raw_base(FLASH1) + FLASH1_RAW_KB * 1024 + SECTOR), -EACCES);
+    host_check_bus();
+}
+
+static void test_reserved(void)
+{
+    struct nor_flash_rawlog_pos pos;
+
+    host_boot_blank();
+    REQUIRE(nor_flash_rawlog_append(data, sizeof(data), 1) == 0);
+    for (flash_device_t device = FLASH1; device <= FLASH2; device++) {
+        uint32_t size = nor_flash_get_device_size(device);
+
+        CHECK_EQ(nor_flash_erase_range(device, wear_copy_addr(device, 0), SECTOR), -EACCES);
+        CHECK_EQ(nor_flash_erase_range(device, size - SECTOR, SECTOR), -EACCES);
+        CHECK_EQ(prog(device, wear_copy_addr(device, 1)), -EACCES);
+        CHECK_EQ(nor_flash_erase_range(device, 0, size), -EACCES);
+        CHECK_EQ(nor_flash_erase_range(device, size, SECTOR), -EINVAL);
+    }
+    CHECK_EQ(nor_flash_erase_range(FLASH2, RAWLOG_BASE, RAWLOG_SEG_SIZE), -EACCES);
+    CHECK_EQ(prog(FLASH2, RAWLOG_BASE + RAWLOG_SEG_SIZE), -EACCES);
+    CHECK_EQ(nor_flash_rawlog_seek(0, &pos), 0);
+
+    /* The driver's own erases of them go ahead */
+    CHECK_EQ(nor_flash_rawlog_clear(), 0);
+    CHECK_EQ(nor_flash_rawlog_seek(0, &pos), -ENODATA);
+    CHECK_EQ(nor_flash_wear_flush(FLASH2), 0);
+    host_check_bus();
+}
+
+static const struct host_test tests[] = {
+    {"raw_region", test_raw_region},
+    {"mounted_lfs", test_mounted_lfs},
+    {"unmounted_lfs", test_unmounted_lfs},
+    {"reserved", test_reserved},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
@@ -0,0 +1,171 @@
+/*
+ * Mount snapshot: the allocator state saved before System OFF is put back
+ * only by the next mount of unchanged flash, and only from the latest save.
+ */
+
+#include "host_nor_flash.h"
+
+#define FILES 8
+
+static char file_data[FILES + 4][600];
+
+static void write_files(int first, int count)
+{
+    char name[16];
+
+    for (int i = first; i < first + count; i++) {
+        snprintf(name, sizeof(name), "f%d", i);
+        memset(file_data[i], 'a' + i, sizeof(file_data[i]));
+        snprintf(file_data[i], sizeof(file_data[i]), "file %d", i);
+        REQUIRE(nor_flash_write_file(FLASH1, name, file_data[i], sizeof(file_data[i])) == 0);
+    }
+}
+
+static void check_files(int count)
+{
+    char name[16], buf[sizeof(file_data[0])];
+
+    for (int i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "f%d", i);
+        CHECK_EQ(nor_flash_read_file(FLASH1, name, buf, sizeof(buf)), sizeof(buf));
+        CHECK(memcmp(buf, file_data[i], sizeof(buf)) == 0);
+    }
+}
+
+/* Wake from System OFF: RAM other than __noinit is gone, then stage 1 runs */
+static void wake(void)
+{
+    k_mutex_lock(&lfs1_lock, K_FOREVER);
+    lfs_unmount(&lfs1);
+    lfs1_mounted = false;
+    memset(lfs1_look_buf, 0, sizeof(lfs1_look_buf));
+    memset(&lfs1, 0, sizeof(lfs1));
+    lfs1_mounted = (lfs_init_mount(FLASH1) == 0);
+    k_mutex_unlock(&lfs1_lock);
+    REQUIRE(lfs1_mounted);
+}
+
+static bool restored(void)
+{
+    return lfs1.free.size != 0;
+}
+
+/* Every block in use ahead of the cursor in the restored window must be
+ * marked in use (blocks behind it were handed out and are never marked) */
+static int mark_in_use(void *data, lfs_block_t block)
+{
+    lfs_t *lfs = data;
+    lfs_block_t i = (block + lfs->cfg->block_count - lfs->free.off) % lfs->cfg->block_count;
+
+    if (i >= lfs->free.i && i < lfs->free.size && !(lfs->free.buffer[i / 32] & (1U << (i % 32)))) {
+        fprintf(stderr, "block %u in use but free in the restored lookahead\n", (unsigned)block);
+        host_failures++;
+    }
+    return 0;
+}
+
+static void test_restore(void)
+{
+    host_boot_blank();
+    write_files(0, FILES);
+
+    REQUIRE(nor_flash_snapshot_save(FLASH1) == 0);
+    struct lfs_snapshot saved = lfs1_snap;
+    CHECK_EQ(saved.generation, 1);
+
+    wake();
+    CHECK(restored());
+    CHECK_EQ(lfs1.free.off, saved.off);
+    CHECK_EQ(lfs1.free.size, saved.size);
+    CHECK_EQ(lfs1.free.i, saved.i);
+    CHECK_EQ(lfs1.free.ack, lfs_cfg1.block_count);
+    CHECK_EQ(lfs1_snap.magic, 0);            /* One-shot */
+    CHECK_EQ(lfs_fs_traverse(&lfs1, mark_in_use, &lfs1), 0);
+
+    /* The restored allocator must not hand out a block still in use */
+    write_files(FILES, 4);
+    check_files(FILES + 4);
+
+    /* Second sleep/wake cycle: the generation moves on */
+    REQUIRE(nor_flash_snapshot_save(FLASH1) == 0);
+    CHECK_EQ(lfs1_snap.generation, 2);
+    wake();
+    CHECK(restored());
+    CHECK_EQ(lfs_fs_traverse(&lfs1, mark_in_use, &lfs1), 0);
+    check_files(FILES + 4);
+    host_check_bus();
+}
+
+/* Anything written after the save changes the seed: full scan instead */
+static void test_changed_flash(void)
+{
+    host_boot_blank();
+    write_files(0, FILES);
+    REQUIRE(nor_flash_snapshot_save(FLASH1) == 0);
+    write_files(FILES, 1);
+
+    wake();
+    CHECK(!restored());
+    CHECK_EQ(lfs1_snap_gen, 1);
+    write_files(FILES + 1, 1);
+    check_files(FILES + 2);
+}
+
+/* An intact snapshot from an earlier save is refused */
+static void test_stale_generation(void)
+{
+    host_boot_blank();
+    write_files(0, FILES);
+    REQUIRE(nor_flash_snapshot_save(FLASH1) == 0);
+    struct lfs_snapshot old = lfs1_snap;
+    uint32_t old_map[ARRAY_SIZE(lfs1_snap_map)];
+    memcpy(old_map, lfs1_snap_map, sizeof(old_map));
+
+    /* Nothing written since, so the old copy's seed still matches */
+    REQUIRE(nor_flash_snapshot_save(FLASH1) == 0);
+    lfs1_snap = old;
+    memcpy(lfs1_snap_map, old_map, sizeof(old_map));
+
+    wake();
+    CHECK(!restored());
+    check_files(FILES);
+}
+
+/* Power-on: retained RAM holds garbage, the expected generation included */
+static void test_cold_boot(void)
+{
+    host_boot_blank();
+    write_files(0, FILES);
+    REQUIRE(nor_flash_snapshot_save(FLASH1) == 0);
+    memset(lfs_snap_expect, 0xA5, sizeof(lfs_snap_expect));
+
+    wake();
+    CHECK(!restored());
+    check_files(FILES);
+}
+
+/* A corrupted bitmap fails the snapshot CRC */
+static void test_corrupt_map(void)
+{
+    host_boot_blank();
+    write_files(0, FILES);
+    REQUIRE(nor_flash_snapshot_save(FLASH1) == 0);
+    lfs1_snap_map[0] ^= 1;
+
+    wake();
+    CHECK(!restored());
+    check_files(FILES);
+}
+
+static const struct host_test tests[] = {
+    {"restore", test_restore},
+    {"changed_flash", test_changed_flash},
+    {"stale_generation", test_stale_generation},
+    {"cold_boot", test_cold_boot},
+    {"corrupt_map", test_corrupt_map},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
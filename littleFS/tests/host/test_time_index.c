@@ -0,0 +1,179 @@
+/*
+ * Recording time index: entries every interval, halved when they run out,
+ * kept across an append reopen, and looked up by nor_flash_seek_time().
+ */
+
+#include "host_nor_flash.h"
+
+#define CHUNK    1024
+#define T0       1700000000U    /* Seconds since 1970 */
+#define RATE     10             /* Seconds per chunk */
+#define REC_FILE "rec.bin"
+
+static uint32_t now;
+
+static uint32_t fake_time(void)
+{
+    return now;
+}
+
+static uint32_t time_at(uint32_t chunk)
+{
+    return T0 + RATE * chunk;
+}
+
+static struct tm tm_at(uint32_t t)
+{
+    time_t tt = t;
+    struct tm tm;
+
+    gmtime_r(&tt, &tm);
+    return tm;
+}
+
+/* Chunks [first, last) at a steady rate, chunk i stamped time_at(i) */
+static void record(nor_flash_file_t *h, uint32_t first, uint32_t last)
+{
+    static uint8_t data[CHUNK];
+
+    for (uint32_t i = first; i < last; i++) {
+        memset(data, (uint8_t)i, sizeof(data));
+        now = time_at(i);
+        REQUIRE(nor_flash_append(h, data, sizeof(data)) == 0);
+    }
+    now = time_at(last);
+}
+
+/* Entries evenly spaced at the interval, each stamped when it was written */
+static void check_index(const struct time_index *idx, uint32_t count, uint32_t interval)
+{
+    CHECK_EQ(idx->count, count);
+    CHECK_EQ(idx->interval, interval);
+    for (uint32_t i = 0; i < idx->count; i++) {
+        CHECK_EQ(idx->entry[i].off, i * interval);
+        CHECK_EQ(idx->entry[i].time, time_at(i * interval / CHUNK));
+    }
+}
+
+/* 20 chunks at 1KB spacing with 8 entries: halved at chunks 8 and 16 */
+static void write_recording(void)
+{
+    nor_flash_file_t *h;
+
+    nor_flash_set_time_source(fake_time);
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_WRITE, &h) == 0);
+    record(h, 0, 8);
+    check_index(&h->index, 8, CHUNK);
+    record(h, 8, 9);
+    check_index(&h->index, 5, 2 * CHUNK);
+    record(h, 9, 20);
+    check_index(&h->index, 5, 4 * CHUNK);
+    REQUIRE(nor_flash_close(h) == 0);
+}
+
+static void test_halving(void)
+{
+    nor_flash_file_t *h;
+
+    host_boot_blank();
+    write_recording();
+
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_READ, &h) == 0);
+    check_index(&h->index, 5, 4 * CHUNK);
+    CHECK_EQ(h->index.end_off, 20 * CHUNK);
+    CHECK_EQ(h->index.end_time, time_at(20));
+    REQUIRE(nor_flash_close(h) == 0);
+    host_check_bus();
+}
+
+/* Appending later picks the stored index up where it stopped */
+static void test_append_reopen(void)
+{
+    nor_flash_file_t *h;
+
+    host_boot_blank();
+    write_recording();
+
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_APPEND, &h) == 0);
+    check_index(&h->index, 5, 4 * CHUNK);
+    record(h, 20, 32);
+    check_index(&h->index, 8, 4 * CHUNK);
+    REQUIRE(nor_flash_close(h) == 0);
+
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_READ, &h) == 0);
+    check_index(&h->index, 8, 4 * CHUNK);
+    CHECK_EQ(h->index.end_off, 32 * CHUNK);
+    REQUIRE(nor_flash_close(h) == 0);
+
+    /* Truncating starts a fresh index */
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_WRITE, &h) == 0);
+    record(h, 0, 2);
+    check_index(&h->index, 2, CHUNK);
+    REQUIRE(nor_flash_close(h) == 0);
+}
+
+/* Steady rate: interpolation lands on the exact offset of any time */
+static void test_seek(void)
+{
+    nor_flash_file_t *h;
+    struct tm tm;
+
+    host_boot_blank();
+    write_recording();
+
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_READ, &h) == 0);
+    for (uint32_t i = 0; i < 20; i++) {
+        tm = tm_at(time_at(i));
+        CHECK_EQ(nor_flash_seek_time(h, &tm), i * CHUNK);
+        tm = tm_at(time_at(i) + RATE / 2);
+        CHECK_EQ(nor_flash_seek_time(h, &tm), i * CHUNK + CHUNK / 2);
+
+        uint8_t byte;
+        CHECK_EQ(lfs_file_read(h->lfs, &h->file, &byte, 1), 1);
+        CHECK_EQ(byte, (uint8_t)i);
+    }
+    tm = tm_at(time_at(20));
+    CHECK_EQ(nor_flash_seek_time(h, &tm), 20 * CHUNK);
+
+    /* Outside the recorded span */
+    tm = tm_at(time_at(0) - 1);
+    CHECK_EQ(nor_flash_seek_time(h, &tm), -ERANGE);
+    tm = tm_at(time_at(20) + 1);
+    CHECK_EQ(nor_flash_seek_time(h, &tm), -ERANGE);
+    REQUIRE(nor_flash_close(h) == 0);
+
+    /* Only readers seek by time */
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_APPEND, &h) == 0);
+    tm = tm_at(time_at(5));
+    CHECK_EQ(nor_flash_seek_time(h, &tm), -EBADF);
+    REQUIRE(nor_flash_close(h) == 0);
+}
+
+/* Written without a time source: no index to seek by */
+static void test_no_source(void)
+{
+    nor_flash_file_t *h;
+    struct tm tm = tm_at(time_at(0));
+
+    host_boot_blank();
+    nor_flash_set_time_source(NULL);
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_WRITE, &h) == 0);
+    record(h, 0, 4);
+    REQUIRE(nor_flash_close(h) == 0);
+
+    REQUIRE(nor_flash_open(FLASH1, REC_FILE, NOR_FLASH_MODE_READ, &h) == 0);
+    CHECK_EQ(nor_flash_seek_time(h, &tm), -ENODATA);
+    REQUIRE(nor_flash_close(h) == 0);
+}
+
+static const struct host_test tests[] = {
+    {"halving", test_halving},
+    {"append_reopen", test_append_reopen},
+    {"seek", test_seek},
+    {"no_source", test_no_source},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}
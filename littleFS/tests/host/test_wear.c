@@ -0,0 +1,280 @@
+/*
+ * Wear table A/B write-back: a power cut anywhere in a write-back leaves
+ * either the previous copy or the complete new one, and pending counts are
+ * only dropped once the new copy is committed.
+ */
+
+#include "host_nor_flash.h"
+
+#define BLOCKS FLASH2_BLOCKS
+
+static uint16_t table[BLOCKS], expect_old[BLOCKS], expect_new[BLOCKS];
+
+static uint8_t pending_of(const struct wear_state *w, lfs_block_t b)
+{
+    return (w->pending[b / 2] >> ((b & 1) * 4)) & 0xF;
+}
+
+/* The stored table of the current copy, zeros if there is none */
+static void read_table(flash_device_t device, uint16_t *out)
+{
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+
+    for (lfs_block_t b = 0; b < w->blocks; b += WEAR_CHUNK) {
+        REQUIRE(wear_read_chunk(device, w->cur, b, MIN(WEAR_CHUNK, w->blocks - b), &out[b]) == 0);
+    }
+}
+
+/* Stored table plus what is pending: what a complete write-back stores */
+static void table_with_pending(flash_device_t device, uint16_t *out)
+{
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+
+    read_table(device, out);
+    for (lfs_block_t b = 0; b < w->blocks; b++) {
+        out[b] = MIN((uint32_t)out[b] + pending_of(w, b), UINT16_MAX);
+    }
+}
+
+/* Power back on: RAM counts are gone and the table is loaded from flash */
+static void reboot(flash_device_t device)
+{
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+
+    mx25l_power_cycle((device == FLASH1) ? &mx25l_flash1 : &mx25l_flash2);
+    memset(w->pending, 0, DIV_ROUND_UP(w->blocks, 2));
+    w->pending_total = 0;
+    w->lost = 0;
+    w->due = false;
+    w->cur = -1;
+    w->seq = 0;
+    wear_load(device);
+}
+
+/* Some erases behind LittleFS's back, counted as the driver's own are;
+ * nor_flash_erase_range() would refuse the mounted blocks */
+static void erase_blocks(flash_device_t device, lfs_block_t first, lfs_block_t count)
+{
+    REQUIRE(erase_range_counted(device, first * FLASH_SECTOR_SIZE, count * FLASH_SECTOR_SIZE) == 0);
+}
+
+static void round_trip(flash_device_t device)
+{
+    struct wear_state *w = (device == FLASH1) ? &wear1 : &wear2;
+
+    erase_blocks(device, 2000, 3);
+    erase_blocks(device, 2001, 1);
+    CHECK_EQ(pending_of(w, 2001), 2);
+    table_with_pending(device, expect_new);
+
+    REQUIRE(nor_flash_wear_flush(device) == 0);
+    uint32_t seq = w->seq;
+
+    /* Only the erase of the copy just written is left, for the next one */
+    lfs_block_t copy_block = wear_copy_addr(device, w->cur) / FLASH_SECTOR_SIZE;
+    CHECK_EQ(pending_of(w, copy_block), 1);
+    CHECK_EQ(w->pending_total, WEAR_COPY_BLOCKS(w->blocks));
+
+    reboot(device);
+    CHECK_EQ(w->seq, seq);
+    read_table(device, table);
+    CHECK(memcmp(table, expect_new, w->blocks * sizeof(table[0])) == 0);
+    CHECK_EQ(table[2001], table[2000] + 1);
+    host_check_bus();
+}
+
+static void test_round_trip_flash1(void)
+{
+    host_boot_blank();
+    round_trip(FLASH1);
+}
+
+static void test_round_trip_flash2(void)
+{
+    host_boot_blank();
+    round_trip(FLASH2);
+}
+
+/* Each copy written in turn, the newest valid one wins after a reboot */
+static void test_alternate(void)
+{
+    host_boot_blank();
+    for (int i = 0; i < 4; i++) {
+        erase_blocks(FLASH2, 100 + i, 1);
+        REQUIRE(nor_flash_wear_flush(FLASH2) == 0);
+        int cur = wear2.cur;
+        reboot(FLASH2);
+        CHECK_EQ(wear2.cur, cur);
+    }
+    read_table(FLASH2, table);
+    for (int i = 0; i < 4; i++) {
+        CHECK_EQ(table[100 + i], 1);
+    }
+}
+
+static void test_torn_writes(void)
+{
+    uint32_t region = wear_copy_addr(FLASH2, 0);
+    size_t region_len = FLASH2_CHIP_SIZE_BYTES - region;
+    size_t table_bytes = BLOCKS * sizeof(uint16_t);
+    size_t total = table_bytes + WEAR_HDR_SIZE;
+    static uint8_t saved_flash[2 * WEAR_COPY_BLOCKS(BLOCKS) * FLASH_SECTOR_SIZE];
+    static uint8_t saved_pending[sizeof(wear2_pending)];
+    struct wear_state saved_state;
+
+    host_boot_blank();
+    REQUIRE(region_len == sizeof(saved_flash));
+
+    /* Copy 0 committed, then more erases pending for copy 1 */
+    erase_blocks(FLASH2, 10, 5);
+    REQUIRE(nor_flash_wear_flush(FLASH2) == 0);
+    erase_blocks(FLASH2, 12, 1);
+    erase_blocks(FLASH2, 3000, 16);
+    read_table(FLASH2, expect_old);
+    table_with_pending(FLASH2, expect_new);
+    uint32_t old_seq = wear2.seq;
+
+    memcpy(saved_flash, &mx25l_flash2.mem[region], region_len);
+    memcpy(saved_pending, wear2_pending, sizeof(saved_pending));
+    saved_state = wear2;
+
+    int cuts = 0;
+    for (size_t cut = 0; cut <= total; cut += (cut + 64 < table_bytes) ? 61 : 1) {
+        memcpy(&mx25l_flash2.mem[region], saved_flash, region_len);
+        memcpy(wear2_pending, saved_pending, sizeof(saved_pending));
+        wear2 = saved_state;
+
+        mx25l_flash2.cut_budget = cut;
+        wear_flush(FLASH2);
+        bool lost = mx25l_flash2.power_lost;
+        reboot(FLASH2);
+        read_table(FLASH2, table);
+
+        if (cut < table_bytes + offsetof(struct wear_hdr, crc)) {
+            /* Table or header incomplete: the previous copy, unchanged */
+            CHECK(lost);
+            CHECK_EQ(wear2.seq, old_seq);
+            CHECK(memcmp(table, expect_old, sizeof(table)) == 0);
+        } else if (wear2.seq == old_seq) {
+            CHECK(memcmp(table, expect_old, sizeof(table)) == 0);
+        } else {
+            /* The CRC may complete early when its last bytes are 0xFF */
+            CHECK_EQ(wear2.seq, old_seq + 1);
+            CHECK(memcmp(table, expect_new, sizeof(table)) == 0);
+        }
+        if (cut == total) {
+            CHECK(!lost);
+            CHECK_EQ(wear2.seq, old_seq + 1);
+        }
+        cuts++;
+    }
+    CHECK(cuts > 100);
+    host_check_bus();
+}
+
+/* A write-back that fails keeps every count pending for the next one */
+static void test_pending_until_commit(void)
+{
+    host_boot_blank();
+    erase_blocks(FLASH2, 500, 4);
+    REQUIRE(nor_flash_wear_flush(FLASH2) == 0);
+    erase_blocks(FLASH2, 501, 1);
+    erase_blocks(FLASH2, 501, 1);
+    erase_blocks(FLASH2, 4000, 1);
+    table_with_pending(FLASH2, expect_new);
+
+    int cur = wear2.cur;
+    uint32_t seq = wear2.seq;
+    size_t progs = DIV_ROUND_UP(BLOCKS, WEAR_CHUNK) + 1;    /* Table chunks, then the header */
+
+    for (long fail = 0; fail < (long)progs; fail++) {
+        mx25l_flash2.fail_progs = fail;
+        CHECK(wear_flush(FLASH2) != 0);
+        CHECK_EQ(wear2.cur, cur);
+        CHECK_EQ(wear2.seq, seq);
+        CHECK_EQ(pending_of(&wear2, 500), 0);
+        CHECK_EQ(pending_of(&wear2, 501), 2);
+        CHECK_EQ(pending_of(&wear2, 4000), 1);
+    }
+
+    /* Every failed attempt erased the other copy once more, and the counts
+     * saturate; they go into the table with the rest */
+    lfs_block_t copy_block = wear_copy_addr(FLASH2, !cur) / FLASH_SECTOR_SIZE;
+    CHECK_EQ(pending_of(&wear2, copy_block), MIN(progs, 0xF));
+    for (lfs_block_t b = copy_block; b < copy_block + WEAR_COPY_BLOCKS(BLOCKS); b++) {
+        expect_new[b] += MIN(progs, 0xF);
+    }
+
+    REQUIRE(wear_flush(FLASH2) == 0);
+    CHECK_EQ(wear2.pending_total, WEAR_COPY_BLOCKS(BLOCKS));
+    read_table(FLASH2, table);
+    CHECK(memcmp(table, expect_new, sizeof(table)) == 0);
+}
+
+/*
+ * Erases noted while a write-back streams the table: one in a chunk already
+ * written stays pending, one in a chunk still to come goes into the copy.
+ */
+static void note_erases(struct mx25l *m, uint32_t addr, size_t len)
+{
+    m->on_prog = NULL;
+    wear_note_erase(FLASH2, 5, 1);
+    wear_note_erase(FLASH2, 300, 1);
+}
+
+static void test_erase_during_flush(void)
+{
+    host_boot_blank();
+    erase_blocks(FLASH2, 5, 1);
+    erase_blocks(FLASH2, 300, 1);
+    REQUIRE(nor_flash_wear_flush(FLASH2) == 0);
+    erase_blocks(FLASH2, 5, 1);
+    erase_blocks(FLASH2, 300, 1);
+    table_with_pending(FLASH2, expect_new);
+
+    /* First program of the write-back is table chunk 0 (blocks 0-127) */
+    mx25l_flash2.on_prog = note_erases;
+    REQUIRE(wear_flush(FLASH2) == 0);
+    read_table(FLASH2, table);
+
+    CHECK_EQ(table[5], expect_new[5]);
+    CHECK_EQ(pending_of(&wear2, 5), 1);
+    CHECK_EQ(table[300], expect_new[300] + 1);
+    CHECK_EQ(pending_of(&wear2, 300), 0);
+    CHECK_EQ(wear2.pending_total, 1 + WEAR_COPY_BLOCKS(BLOCKS));
+}
+
+/* A full batch queues the write-back on the wear work queue */
+static void test_batch_work(void)
+{
+    host_boot_blank();
+    host_work_run();
+    REQUIRE(nor_flash_wear_flush(FLASH2) == 0);
+    uint32_t seq = wear2.seq;
+
+    /* The write-back's own erase of its copy is pending already */
+    erase_blocks(FLASH2, 1000, NOR_FLASH_WEAR_BATCH - 1 - wear2.pending_total);
+    CHECK(!wear2.due);
+    CHECK_EQ(host_work_run(), 0);
+    erase_blocks(FLASH2, 1000 + NOR_FLASH_WEAR_BATCH, 1);
+    CHECK(wear2.due);
+    CHECK_EQ(host_work_run(), 1);
+    CHECK_EQ(wear2.seq, seq + 1);
+    CHECK_EQ(wear2.pending_total, WEAR_COPY_BLOCKS(BLOCKS));
+    CHECK(!wear2.due);
+}
+
+static const struct host_test tests[] = {
+    {"round_trip_flash1", test_round_trip_flash1},
+    {"round_trip_flash2", test_round_trip_flash2},
+    {"alternate", test_alternate},
+    {"torn_writes", test_torn_writes},
+    {"pending_until_commit", test_pending_until_commit},
+    {"erase_during_flush", test_erase_during_flush},
+    {"batch_work", test_batch_work},
+};
+
+int main(int argc, char **argv)
+{
+    return host_main(argc, argv, tests, ARRAY_SIZE(tests));
+}